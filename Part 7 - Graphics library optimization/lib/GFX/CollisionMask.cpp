@@ -0,0 +1,116 @@
+/* CollisionMask.cpp */
+
+#include "CollisionMask.h"
+
+CollisionMask::CollisionMask() {
+    // An empty mask, which collides with nothing
+    left = 0;
+    top = 0;
+    width = 0;
+    height = 0;
+    words = 0;
+    bits = NULL;
+}
+
+bool CollisionMask::begin(const uint8_t* bitmap, uint16_t bitmapWidth, uint16_t bitmapHeight, uint8_t transparentColor) {
+    // Build the mask of the pixels that are not transparent, cropped to their
+    // bounding box. The previous mask is freed. Returns false if the mask
+    // can't be allocated.
+    end();
+    int16_t right = -1;
+    int16_t bottom = -1;
+    left = bitmapWidth;
+    top = bitmapHeight;
+    for(int v = 0; v < bitmapHeight; v++) {
+        for(int u = 0; u < bitmapWidth; u++) {
+            if(bitmap[bitmapWidth * v + u] != transparentColor) {
+                if(u < left) left = u;
+                if(u > right) right = u;
+                if(v < top) top = v;
+                bottom = v;
+            }
+        }
+    }
+    if(right < 0)
+        return true;
+
+    uint16_t maskWidth = right - left + 1;
+    uint16_t maskHeight = bottom - top + 1;
+    words = (maskWidth + 31) / 32;
+    bits = (uint32_t*)calloc(words * maskHeight, sizeof(uint32_t));
+    if(bits == NULL) {
+        words = 0;
+        return false;
+    }
+    width = maskWidth;
+    height = maskHeight;
+    for(int v = 0; v < height; v++) {
+        const uint8_t* pixel = bitmap + bitmapWidth * (top + v) + left;
+        uint32_t* row = bits + words * v;
+        for(int u = 0; u < width; u++) {
+            if(pixel[u] != transparentColor)
+                row[u >> 5] |= 0x80000000 >> (u & 31);
+        }
+    }
+    return true;
+}
+
+void CollisionMask::end() {
+    // Free the mask: it collides with nothing until begin is called again
+    free(bits);
+    bits = NULL;
+    width = 0;
+    height = 0;
+    words = 0;
+}
+
+bool CollisionMask::collides(int16_t x, int16_t y, CollisionMask* other, int16_t otherX, int16_t otherY) {
+    // Check if the opaque pixels of two bitmaps drawn at (x, y) and
+    // (otherX, otherY) overlap. Most pairs are rejected by their bounding
+    // boxes; the others AND the rows of the masks a word at a time.
+    if(width == 0 || other->width == 0)
+        return false;
+    int16_t ax = x + left;
+    int16_t ay = y + top;
+    int16_t bx = otherX + other->left;
+    int16_t by = otherY + other->top;
+    if(ax >= bx + other->width || bx >= ax + width)
+        return false;
+    if(ay >= by + other->height || by >= ay + height)
+        return false;
+
+    // Let a be the mask on the left, so b is shifted right by shift bits
+    CollisionMask* a = this;
+    CollisionMask* b = other;
+    if(bx < ax) {
+        a = other;
+        b = this;
+        int16_t t = ax;
+        ax = bx;
+        bx = t;
+        t = ay;
+        ay = by;
+        by = t;
+    }
+    int16_t shift = bx - ax;
+    int16_t wordShift = shift >> 5;
+    int16_t bitShift = shift & 31;
+
+    // Rows where the bounding boxes overlap
+    int16_t yStart = (ay > by) ? ay : by;
+    int16_t yEnd = (ay + a->height < by + b->height) ? ay + a->height : by + b->height;
+    const uint32_t* rowA = a->bits + a->words * (yStart - ay);
+    const uint32_t* rowB = b->bits + b->words * (yStart - by);
+    for(int16_t row = yStart; row < yEnd; row++, rowA += a->words, rowB += b->words) {
+        // Word k of a overlaps words j - 1 and j of b, with j = k - wordShift
+        for(int16_t k = wordShift; k < a->words; k++) {
+            int16_t j = k - wordShift;
+            uint32_t shifted = (j < b->words) ? rowB[j] >> bitShift : 0;
+            if(bitShift != 0 && j > 0 && j <= b->words)
+                shifted |= rowB[j - 1] << (32 - bitShift);
+            if(rowA[k] & shifted)
+                return true;
+        }
+    }
+    return false;
+}
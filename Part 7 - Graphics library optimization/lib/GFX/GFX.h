@@ -28,55 +28,220 @@
 #define ONSCREEN(x,y) (x >= 0 && x < 320 && y >= 0 && y < 480)
 #define DIRTY_RECT_X(x)  ((x) >> 6)
 
+// Polygon fill rules
+#define FILL_EVEN_ODD           0
+#define FILL_NONZERO            1
+#define POLYGON_STACK_EDGES     16      // Bigger polygons allocate their edge table
+
+// Bitmap flip flags
+#define FLIP_NONE               0
+#define FLIP_HORIZONTAL         1
+#define FLIP_VERTICAL           2
+
+// Remap table effects
+#define REMAP_WHITE             0       // Every color becomes white
+#define REMAP_DARKEN            1       // Brightness reduced by amount (0 to 1)
+#define REMAP_SHIFT_HUE         2       // Hue rotated by amount degrees
+
+struct Point {
+    int16_t x;
+    int16_t y;
+};
+
 struct Font {
     uint8_t* data;
     uint8_t width;
     uint8_t height;
 };
 
-float fastSin(int deg);
-float fastCos(int deg);
+struct ProportionalGlyph {
+    uint16_t offset;    // Offset of the glyph bitmap in the font data
+    uint8_t width;      // Size of the cropped glyph bitmap
+    uint8_t height;
+    int8_t xOffset;     // Bitmap position relative to the cursor and to the top of the line
+    int8_t yOffset;
+    uint8_t xAdvance;   // Horizontal cursor movement after the glyph
+};
+
+struct KerningPair {
+    uint8_t left;
+    uint8_t right;
+    int8_t adjust;
+};
+
+struct ProportionalFont {
+    uint8_t* data;                  // Cropped glyph bitmaps, every row padded to a whole byte
+    ProportionalGlyph* glyphs;      // One glyph for every character from first to last
+    uint8_t first;
+    uint8_t last;
+    uint8_t height;                 // Line height
+    KerningPair* kerning;           // Sorted by left and right character, can be NULL
+    uint16_t kerningCount;
+};
+
+#define TEXT_LABEL_LENGTH       32
+
+struct TextLabel {
+    int16_t x;
+    int16_t y;
+    uint8_t color;
+    uint8_t backgroundColor;            // Color of the pixels a glyph no longer covers
+    Font* font;                         // Font of the label, NULL => not initialized
+    char text[TEXT_LABEL_LENGTH + 1];   // Text currently on screen
+};
+
+#define CIRCLE_TABLE_RADIUS     32      // Default largest radius with a cached circle table
+
+#define CLIP_STACK_DEPTH        8
+
+// Clipping rectangle and origin in screen coordinates, saved by pushClipRect
+struct ClipRect {
+    int16_t left;
+    int16_t top;
+    int16_t right;      // Inclusive, right < left if nothing can be drawn
+    int16_t bottom;     // Inclusive
+    int16_t originX;    // Screen position of the point (0, 0)
+    int16_t originY;
+};
+
+// Offscreen render target. A surface can be as big as the screen, and its
+// stride lets it be a view of a rectangle inside a bigger surface. Surfaces
+// don't track dirty rectangles: blitting one marks the cells it covers.
+struct Surface {
+    uint16_t width;
+    uint16_t height;
+    uint16_t stride;    // Bytes from the start of a row to the start of the next one
+    uint8_t* pixels;
+};
+
+#define ANGLE_STEPS             1024    // Angle units in a full turn for sinQ15/cosQ15
+
+int16_t sinQ15(int32_t angle);
+int16_t cosQ15(int32_t angle);
+float fastSin(float deg);
+float fastCos(float deg);
+float fastAtan2(float y, float x);
+char* formatInteger(char* buffer, int32_t value, uint8_t width = 0, char padding = ' ');
+
+struct ArcRange;
+struct EdgeTable;
 
 class GFX {
     public:
     void begin();
     void update();
     void fillScreen(uint8_t color);
-    void drawPixel(uint16_t x, uint16_t y, uint8_t color);
+    bool pushClipRect(int16_t x, int16_t y, uint16_t width, uint16_t height);
+    void popClipRect();
+    void setOrigin(int16_t x, int16_t y);
+    bool createSurface(Surface* surface, uint16_t width, uint16_t height);
+    void freeSurface(Surface* surface);
+    bool setTarget(Surface* surface);
+    Surface* getTarget();
+    void blitSurface(Surface* surface, int16_t x, int16_t y);
+    void blitSurface(Surface* surface, int16_t x, int16_t y, uint8_t transparentColor);
+    void drawPixel(int16_t x, int16_t y, uint8_t color);
+    void drawPoints(const Point* points, uint16_t count, uint8_t color);
+    void movePoints(const Point* oldPoints, const Point* newPoints, uint16_t count, uint8_t color, uint8_t backgroundColor);
     void drawHorizontalLine(int16_t x, int16_t y, uint16_t width, uint8_t color);
     void drawVerticalLine(int16_t x, int16_t y, uint16_t height, uint8_t color);
     void drawLine(int16_t xStart, int16_t yStart, int16_t xEnd, int16_t yEnd, uint8_t color);
+    void drawThickLine(int16_t xStart, int16_t yStart, int16_t xEnd, int16_t yEnd, uint8_t width, uint8_t color);
+    void drawPolyline(const Point* points, uint16_t count, uint8_t width, uint8_t color);
     void drawRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
     void drawFilledRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
     void drawTriangle(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2, uint8_t color);
+    void drawFilledPolygon(const Point* points, uint16_t count, uint8_t color, uint8_t fillRule = FILL_EVEN_ODD);
     void drawFilledTriangle(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2, uint8_t color);
     void drawCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color);
     void drawFilledCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color);
-    void drawBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height);
-    void drawTransparentBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor);
+    void drawEllipse(int16_t x, int16_t y, uint16_t radiusX, uint16_t radiusY, uint8_t color);
+    void drawFilledEllipse(int16_t x, int16_t y, uint16_t radiusX, uint16_t radiusY, uint8_t color);
+    void drawRoundedRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint8_t color);
+    void drawFilledRoundedRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint8_t color);
+    void drawArc(int16_t x, int16_t y, uint16_t radius, float startAngle, float endAngle, uint8_t color);
+    void setCircleTableRadius(uint8_t maxRadius);
+    void drawBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t flip = FLIP_NONE);
+    void drawTransparentBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor, uint8_t flip = FLIP_NONE);
+    void drawTransparentBitmapSaveUnder(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor,
+            uint8_t* saveBuffer, uint8_t flip = FLIP_NONE);
+    void restoreSaveUnder(uint8_t* saveBuffer, int16_t x, int16_t y, uint16_t width, uint16_t height);
+    void drawRemappedBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t* remap, uint8_t flip = FLIP_NONE);
+    void drawTransparentRemappedBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor,
+            const uint8_t* remap, uint8_t flip = FLIP_NONE);
+    void buildRemapTable(uint8_t* table, uint16_t size, uint8_t effect, float amount = 0);
     void scaleAndRotateBitmap(uint8_t* destination, uint16_t* destinationWidth, uint16_t* destinationHeight,
             uint8_t* source, uint16_t sourceWidth, uint16_t sourceHeight, float scaleX, float scaleY, float rotation, uint_fast16_t backgroundColor = 0);
+    void getScaledAndRotatedSize(uint16_t* destinationWidth, uint16_t* destinationHeight,
+            uint16_t sourceWidth, uint16_t sourceHeight, float scaleX, float scaleY, float rotation);
+    void drawRotatedScaledBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height,
+            float scaleX, float scaleY, float rotation, uint8_t transparentColor);
     void copyScreenBufferRect(uint8_t* buffer, int16_t x, int16_t y, uint16_t width, uint16_t height);
+    void copyRect(int16_t sourceX, int16_t sourceY, uint16_t width, uint16_t height, int16_t destinationX, int16_t destinationY);
+    void scrollRegion(int16_t dx, int16_t dy, uint8_t fillColor);
     void drawMonochromeBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
     void drawMonochromeBitmap2x(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
+    void drawMonochromeBitmapScaled(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color, uint8_t scale);
     void setFont(Font* f);
+    Font* getFont();
+    uint16_t getStringWidth(const char* string, uint8_t scale = 1);
+    uint16_t getStringHeight(const char* string, uint8_t scale = 1);
+    void clearGlyphCache();
     void drawChar(int16_t x, int16_t y, char character, uint8_t color);
     void drawChar2x(int16_t x, int16_t y, char character, uint8_t color);
+    void drawCharScaled(int16_t x, int16_t y, char character, uint8_t color, uint8_t scale);
     void drawString(int16_t x, int16_t y, const char* string, uint8_t color);
     void drawString2x(int16_t x, int16_t y, const char* string, uint8_t color);
+    void drawStringScaled(int16_t x, int16_t y, const char* string, uint8_t color, uint8_t scale);
+    void setProportionalFont(ProportionalFont* f);
+    int16_t drawProportionalChar(int16_t x, int16_t y, char character, uint8_t color);
+    void drawProportionalString(int16_t x, int16_t y, const char* string, uint8_t color);
+    int8_t getKerning(char left, char right);
+    bool initTextLabel(TextLabel* label, int16_t x, int16_t y, uint8_t color, uint8_t backgroundColor);
+    void drawTextLabel(TextLabel* label, int16_t x, int16_t y, const char* text, uint8_t color);
+    void eraseTextLabel(TextLabel* label);
     void loadDefaultPalette();
     void loadPalette(uint16_t* newPalette, int size);
 
     private:
+#ifdef GFX_TEST
+    friend struct GFXTest;          // Host tests read the screen buffer, the dirty map and the clipping state
+#endif
     uint8_t* screenBuffer[2]; // 0 => Top sector, 1 => Bottom sector
     uint16_t palette[256];
-    uint8_t dirtyRects[480][5];
+    uint8_t screenDirtyRects[480][5];
+    uint8_t (*dirtyRects)[5];       // screenDirtyRects, or a discarded array if the target is a surface
     int16_t scanLine;
     Font* font;
     uint16_t fontSize;
+    uint8_t* glyphCache2x[256];    // Scale2x glyphs, allocated on first use
+    uint8_t* circleTable;           // Half widths of circle rows, one table per radius
+    uint8_t circleTableRadius;
+    ProportionalFont* proportionalFont;
+    ClipRect clipRect;
+    ClipRect clipStack[CLIP_STACK_DEPTH];
+    uint8_t clipStackSize;
+    Surface* target;                // NULL => Screen buffer
 
     void setAddressWindow(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
-    int16_t cropToViewSize(int16_t* start, uint16_t* length, uint16_t viewSize);
+    void resetClipRect(uint16_t width, uint16_t height);
+    void drawRemappedRows(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, bool transparent, uint8_t transparentColor,
+            const uint8_t* remap, uint8_t flip);
+    uint8_t closestColor(int16_t r, int16_t g, int16_t b, uint16_t size);
+    void blitSurfaceRows(Surface* surface, int16_t x, int16_t y, bool transparent, uint8_t transparentColor);
+    int16_t cropToView(int16_t* start, uint16_t* length, int16_t viewStart, int16_t viewEnd);
+    uint8_t* lineAddress(int16_t y);
+    void drawSpan(int16_t y, int16_t x1, int16_t x2, uint8_t color);
+    void drawColumn(int16_t x, int16_t y, int16_t y2, uint8_t color);
+    void drawClippedSpan(int16_t y, int16_t x1, int16_t x2, uint8_t color);
+    void drawClippedColumn(int16_t x, int16_t y1, int16_t y2, uint8_t color);
+    void drawClippedPixel(int16_t x, int16_t y, uint8_t color);
+    uint8_t* getCircleTable(uint16_t radius);
+    void fillRowPair(int16_t y1, int16_t y2, int16_t x1, int16_t x2, uint8_t color, bool clip);
+    void outlineRow(int16_t y, int16_t left, int16_t right, int16_t inner, int16_t outer, uint8_t color, bool clip);
+    void fillEdgeTable(EdgeTable* table, uint8_t color, uint8_t fillRule);
+    void arcRow(int16_t x, int16_t y, int16_t v, int16_t inner, int16_t outer, ArcRange* arc, uint8_t color);
+    void updateLabelCell(TextLabel* label, int cell, char oldChar, char newChar, uint8_t color);
 };
 
 #endif
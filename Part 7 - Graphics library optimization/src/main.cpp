@@ -5,17 +5,15 @@
 #include "DefaultFont.h"
 #include "bitmaps.h"
 
-#define STARSHIP_COUNT 1
+#define STARSHIP_COUNT 20
 
 struct StarShip {
     float x;
     float y;
     float theta;
-    float previousTheta;
     float xTarget;
     float yTarget;
     uint8_t* backgroundCopy;
-    uint8_t* rotatedBitmap;
     uint16_t width;
     uint16_t height;
 };
@@ -26,6 +24,17 @@ unsigned long lastUpdate;
 unsigned long frames;
 double avgFps;
 
+void drawStarship(StarShip* ship) {
+    // Calculate starship bounding box
+    gfx.getScaledAndRotatedSize(&ship->width, &ship->height, 32, 32, 1.5, 1.5, ship->theta);
+
+    // Copy background
+    gfx.copyScreenBufferRect(ship->backgroundCopy, ship->x-ship->width/2, ship->y-ship->height/2, ship->width, ship->height);
+
+    // Draw starship
+    gfx.drawRotatedScaledBitmap(starship, ship->x-ship->width/2, ship->y-ship->height/2, 32, 32, 1.5, 1.5, ship->theta, 15);
+}
+
 void setup() {
     // Start graphics library
     gfx.begin();
@@ -45,22 +54,13 @@ void setup() {
         // Generate start data
         ships[i].x = random(30, 290);
         ships[i].y = random(30, 450);
-        ships[i].theta = ships[i].previousTheta = random(0, 360);
+        ships[i].theta = random(0, 360);
         ships[i].xTarget = random(0, 320);
         ships[i].yTarget = random(0, 480);
         ships[i].backgroundCopy = (uint8_t*)malloc(4624);
-        ships[i].rotatedBitmap = (uint8_t*)malloc(4624);
-
-        // Prepare starship bitmap
-        gfx.scaleAndRotateBitmap(ships[i].rotatedBitmap, &ships[i].width, &ships[i].height, starship, 32, 32, 1.5, 1.5, ships[i].theta, 15);
 
-        // Copy background
-        gfx.copyScreenBufferRect(ships[i].backgroundCopy, ships[i].x-ships[i].width/2, ships[i].y-ships[i].height/2, ships[i].width, ships[i].height);
-    }
-
-    for(int i=0; i<STARSHIP_COUNT; i++) {
         // Draw starship
-        gfx.drawTransparentBitmap(ships[i].rotatedBitmap, ships[i].x-ships[i].width/2, ships[i].y-ships[i].height/2, ships[i].width, ships[i].height, 15);
+        drawStarship(&ships[i]);
     }
 
     // Start time
@@ -77,15 +77,15 @@ void loop() {
     float deltaTime = (float)(now - lastUpdate) / 1000000;
     lastUpdate = now;
 
-    // Restore background
-    for(int i=0; i<STARSHIP_COUNT; i++) {
+    // Restore background, in reverse order since starships can overlap
+    for(int i=STARSHIP_COUNT-1; i>=0; i--) {
         gfx.drawBitmap(ships[i].backgroundCopy, ships[i].x-ships[i].width/2, ships[i].y-ships[i].height/2, ships[i].width, ships[i].height);
     }
 
     // Update starship position, rotation and target
     for(int i=0; i<STARSHIP_COUNT; i++) {
         // Update starship rotation
-        float thetaTarget = atan2(ships[i].yTarget - ships[i].y, ships[i].xTarget - ships[i].x) * 57.2957795 + 90;
+        float thetaTarget = fastAtan2(ships[i].yTarget - ships[i].y, ships[i].xTarget - ships[i].x) + 90;
 
         // Turn the starship to the target in the direction of the smallest angle
         if(fabs(thetaTarget - ships[i].theta) > 180) {
@@ -109,21 +109,9 @@ void loop() {
         }
     }
 
-    for(int i=0; i<STARSHIP_COUNT; i++) {
-        // Prepare starship bitmap
-        if(abs(ships[i].theta - ships[i].previousTheta) >= 2) {
-            gfx.scaleAndRotateBitmap(ships[i].rotatedBitmap, &ships[i].width, &ships[i].height, starship, 32, 32, 1.5, 1.5, ships[i].theta, 15);
-            ships[i].previousTheta = ships[i].theta;
-        }
-
-        // Copy background
-        gfx.copyScreenBufferRect(ships[i].backgroundCopy, ships[i].x-ships[i].width/2, ships[i].y-ships[i].height/2, ships[i].width, ships[i].height);
-    }
-
-    for(int i=0; i<STARSHIP_COUNT; i++) {
-        // Draw starship
-        gfx.drawTransparentBitmap(ships[i].rotatedBitmap, ships[i].x-ships[i].width/2, ships[i].y-ships[i].height/2, ships[i].width, ships[i].height, 15);
-    }
+    // Draw starships
+    for(int i=0; i<STARSHIP_COUNT; i++)
+        drawStarship(&ships[i]);
 
     // Draw frame rate
     double fps = 1.0 / deltaTime;
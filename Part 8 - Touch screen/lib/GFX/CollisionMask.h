@@ -0,0 +1,24 @@
+/* CollisionMask.h */
+
+#ifndef _COLLISION_MASK_H
+#define _COLLISION_MASK_H
+
+#include <Arduino.h>
+
+class CollisionMask {
+    public:
+    CollisionMask();
+    bool begin(const uint8_t* bitmap, uint16_t bitmapWidth, uint16_t bitmapHeight, uint8_t transparentColor);
+    void end();
+    bool collides(int16_t x, int16_t y, CollisionMask* other, int16_t otherX, int16_t otherY);
+
+    private:
+    int16_t left;       // Bounding box of the opaque pixels in the bitmap
+    int16_t top;
+    uint16_t width;     // 0 => No opaque pixels
+    uint16_t height;
+    uint16_t words;     // 32 bit words per row
+    uint32_t* bits;     // One bit per pixel, the leftmost pixel in the most significant bit
+};
+
+#endif
@@ -0,0 +1,56 @@
+/* TextLayout.h */
+
+#ifndef _TEXT_LAYOUT_H
+#define _TEXT_LAYOUT_H
+
+#include <Arduino.h>
+#include "GFX.h"
+
+// Text alignment
+#define TEXT_ALIGN_LEFT         0
+#define TEXT_ALIGN_CENTER       1
+#define TEXT_ALIGN_RIGHT        2
+
+struct LayoutGlyph {
+    int16_t x;      // Position relative to the top left corner of the box
+    int16_t y;
+    char character;
+};
+
+class TextLayout {
+    public:
+    TextLayout();
+    bool begin(GFX* g, uint16_t maxLength);
+    void end();
+    void setBox(int16_t x, int16_t y, uint16_t width, uint16_t height);
+    void setAlignment(uint8_t textAlignment);
+    void setScale(uint8_t textScale);
+    void draw(const char* string, uint8_t color);
+    void invalidate();
+    uint16_t getLineCount();
+    uint16_t getWidth();
+    uint16_t getHeight();
+    uint32_t getLayoutCount();
+
+    private:
+    GFX* gfx;
+    Font* font;
+    int16_t boxX;
+    int16_t boxY;
+    uint16_t boxWidth;
+    uint16_t boxHeight;     // 0 => No limit on the number of lines
+    uint8_t alignment;
+    uint8_t scale;
+    uint16_t length;        // Maximum number of laid out characters
+    char* text;             // Copy of the laid out text
+    LayoutGlyph* glyphs;
+    uint16_t glyphCount;
+    uint16_t lineCount;
+    uint16_t textWidth;
+    bool valid;
+    uint32_t layoutCount;
+
+    void layout(const char* string);
+};
+
+#endif
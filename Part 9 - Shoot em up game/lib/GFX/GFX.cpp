@@ -2,132 +2,116 @@
 
 #include "GFX.h"
 
-float sinTable[91] = {
-    0,
-    0.017452406,
-    0.034899497,
-    0.052335956,
-    0.069756474,
-    0.087155743,
-    0.104528463,
-    0.121869343,
-    0.139173101,
-    0.156434465,
-    0.173648178,
-    0.190808995,
-    0.207911691,
-    0.224951054,
-    0.241921896,
-    0.258819045,
-    0.275637356,
-    0.292371705,
-    0.309016994,
-    0.325568154,
-    0.342020143,
-    0.35836795,
-    0.374606593,
-    0.390731128,
-    0.406736643,
-    0.422618262,
-    0.438371147,
-    0.4539905,
-    0.469471563,
-    0.48480962,
-    0.5,
-    0.515038075,
-    0.529919264,
-    0.544639035,
-    0.559192903,
-    0.573576436,
-    0.587785252,
-    0.601815023,
-    0.615661475,
-    0.629320391,
-    0.64278761,
-    0.656059029,
-    0.669130606,
-    0.68199836,
-    0.69465837,
-    0.707106781,
-    0.7193398,
-    0.731353702,
-    0.743144825,
-    0.75470958,
-    0.766044443,
-    0.777145961,
-    0.788010754,
-    0.79863551,
-    0.809016994,
-    0.819152044,
-    0.829037573,
-    0.838670568,
-    0.848048096,
-    0.857167301,
-    0.866025404,
-    0.874619707,
-    0.882947593,
-    0.891006524,
-    0.898794046,
-    0.906307787,
-    0.913545458,
-    0.920504853,
-    0.927183855,
-    0.933580426,
-    0.939692621,
-    0.945518576,
-    0.951056516,
-    0.956304756,
-    0.961261696,
-    0.965925826,
-    0.970295726,
-    0.974370065,
-    0.978147601,
-    0.981627183,
-    0.984807753,
-    0.987688341,
-    0.990268069,
-    0.992546152,
-    0.994521895,
-    0.996194698,
-    0.99756405,
-    0.998629535,
-    0.999390827,
-    0.999847695,
-    1
+// First quadrant of the sine function in Q15 format, 256 steps (ANGLE_STEPS / 4)
+// plus the closing value for 90 degrees
+const int16_t sinTable[257] PROGMEM = {
+        0,   201,   402,   603,   804,  1005,  1206,  1407,  1608,  1809,  2009,  2210,  2411,  2611,  2811,  3012,
+     3212,  3412,  3612,  3812,  4011,  4211,  4410,  4609,  4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,
+     6393,  6590,  6787,  6983,  7180,  7376,  7571,  7767,  7962,  8157,  8351,  8546,  8740,  8933,  9127,  9319,
+     9512,  9704,  9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605, 11793, 11980, 12167, 12354,
+    12540, 12725, 12910, 13095, 13279, 13463, 13646, 13828, 14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+    15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673, 16846, 17018, 17190, 17361, 17531, 17700, 17869, 18037,
+    18205, 18372, 18538, 18703, 18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001, 20160, 20318, 20475, 20632,
+    20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856, 22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028,
+    23170, 23312, 23453, 23593, 23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680, 24812, 24943, 25073, 25202,
+    25330, 25457, 25583, 25708, 25833, 25956, 26078, 26199, 26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+    27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002, 28106, 28209, 28311, 28411, 28511, 28610, 28707, 28803,
+    28899, 28993, 29086, 29178, 29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038, 30118, 30196,
+    30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784, 30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298,
+    31357, 31415, 31471, 31527, 31581, 31634, 31686, 31737, 31786, 31834, 31881, 31927, 31972, 32015, 32058, 32099,
+    32138, 32177, 32214, 32251, 32286, 32319, 32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+    32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738, 32746, 32753, 32758, 32762, 32766, 32767,
+    32767
 };
 
-float fastSin(int deg) {
-    while(deg < 0)
-        deg += 360;
-    while(deg > 360)
-        deg -= 360;
-
-    if(deg <= 90) {
-        return sinTable[deg];
-    } else if(deg <= 180) {
-        return sinTable[180-deg];
-    } else if(deg <= 270) {
-        return -sinTable[deg-180];
-    } else {
-        return -sinTable[360-deg];
-    }
+int16_t sinQ15(int32_t angle) {
+    // Fold the angle into the first quadrant without branches. In odd quadrants
+    // the table is read backwards, in the second half turn the value is negated.
+    uint32_t a = angle & (ANGLE_STEPS - 1);
+    uint32_t quadrant = a / (ANGLE_STEPS / 4);
+    uint32_t mirror = -(quadrant & 1);
+    uint32_t index = ((a & (ANGLE_STEPS / 4 - 1)) ^ mirror) + (mirror & (ANGLE_STEPS / 4 + 1));
+    int32_t negate = -(int32_t)(quadrant >> 1);
+    return (sinTable[index] ^ negate) - negate;
 }
 
-float fastCos(int deg) {
-    while(deg < 0)
-        deg += 360;
-    while(deg > 360)
-        deg -= 360;
-    
-    if(deg <= 90) {
-        return sinTable[90-deg];
-    } else if(deg <= 180) {
-        return -sinTable[deg-90];
-    } else if(deg <= 270) {
-        return -sinTable[270-deg];
-    } else {
-        return sinTable[deg-270];
-    }
+int16_t cosQ15(int32_t angle) {
+    return sinQ15(angle + ANGLE_STEPS / 4);
+}
+
+// Convert degrees to the nearest angle unit. The offset (a multiple of a full
+// turn) keeps the value positive, so truncation rounds negative angles correctly.
+static inline int32_t degreesToAngle(float deg) {
+    return (int32_t)(deg * (ANGLE_STEPS / 360.0f) + (256 * ANGLE_STEPS + 0.5f));
+}
+
+// Sine of the nearest angle unit. The table peaks at 32767, dividing by it
+// makes the quadrant angles exactly +-1: sizes like 32 * cos(0) must not
+// truncate to 31.
+float fastSin(float deg) {
+    return sinQ15(degreesToAngle(deg)) * (1.0f / 32767);
+}
+
+float fastCos(float deg) {
+    return cosQ15(degreesToAngle(deg)) * (1.0f / 32767);
+}
+
+// Slow, accurate variant of fastSin for the sizes and mappings of rotated
+// bitmaps, which are computed once per bitmap. Interpolating between the two
+// nearest table steps is accurate to 0.00005 at any angle; rounding to a step
+// would turn 5 degrees into 4.92 and change the size of the bitmap.
+static float interpolatedSin(float deg) {
+    float steps = deg * (ANGLE_STEPS / 360.0f);
+    int32_t angle = (int32_t)steps;
+    if(steps < angle)
+        angle--;
+    int16_t a = sinQ15(angle);
+    int16_t b = sinQ15(angle + 1);
+    return (a + (b - a) * (steps - angle)) * (1.0f / 32767);
+}
+
+static float interpolatedCos(float deg) {
+    return interpolatedSin(deg + 90);
+}
+
+float fastAtan2(float y, float x) {
+    // Polynomial approximation of atan in the first octant, max error 0.1 degrees
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    if(ax == 0 && ay == 0)
+        return 0;
+    float z = (ax >= ay) ? (ay / ax) : (ax / ay);
+    float angle = 57.2957795f * (0.7853982f * z - z * (z - 1) * (0.2447f + 0.0663f * z));
+
+    // Move the result to the right octant
+    if(ay > ax)
+        angle = 90 - angle;
+    if(x < 0)
+        angle = 180 - angle;
+    return (y < 0) ? -angle : angle;
+}
+
+char* formatInteger(char* buffer, int32_t value, uint8_t width, char padding) {
+    // Write the digits backwards in a temporary buffer
+    char digits[11];
+    int count = 0;
+    uint32_t magnitude = (value < 0) ? -(uint32_t)value : value;
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while(magnitude != 0);
+
+    // Right align to the requested width, then copy sign and digits
+    char* p = buffer;
+    int length = count + (value < 0);
+    for( ; length < width; length++)
+        *p++ = padding;
+    if(value < 0)
+        *p++ = '-';
+    while(count > 0)
+        *p++ = digits[--count];
+    *p = 0;
+    return buffer;
 }
 
 void GFX::begin() {
@@ -195,12 +179,24 @@ void GFX::begin() {
     screenBuffer[0] = (uint8_t*)malloc(81920); // 320x256 pixels
     screenBuffer[1] = (uint8_t*)malloc(71680); // 320x224 pixels
 
+    // Draw on the whole screen
+    target = NULL;
+    dirtyRects = screenDirtyRects;
+    resetClipRect(320, 480);
+
     // Load default 16 color palette and fill screen with black (index 15)
     loadDefaultPalette();
     fillScreen(15);
 
     // Starting scan line
     scanLine = 0;
+
+    // Empty glyph cache
+    memset(glyphCache2x, 0, sizeof(glyphCache2x));
+
+    // Circle tables are allocated on first use
+    circleTable = NULL;
+    circleTableRadius = CIRCLE_TABLE_RADIUS;
 }
 
 void GFX::update() {
@@ -214,11 +210,11 @@ void GFX::update() {
     // If the number of rectangles to redraw is greater than 900, switch
     // to interlaced mode: only the odd or even rows are checked, based
     // on the current scan line.
-    int dirtyRectsCount = 0;
+    int screenDirtyRectsCount = 0;
     for(int rect = 0; rect < 5; rect++)
         for(int v = 0; v < 480; v++)
-            dirtyRectsCount += dirtyRects[v][rect];
-    if(dirtyRectsCount > 900) {
+            screenDirtyRectsCount += screenDirtyRects[v][rect];
+    if(screenDirtyRectsCount > 900) {
         stepY = 2;
         startY = scanLine;
     }
@@ -230,7 +226,7 @@ void GFX::update() {
     // Top framebuffer sector
     for(y = startY; y < 256; y = y + stepY) {
         for(int rect = 0; rect < 5; rect++) {
-            if(dirtyRects[y][rect]) {
+            if(screenDirtyRects[y][rect]) {
                 int xStart = rect << 6;
                 int offset = 320 * y;
                 for(int x = 0; x < 64; x++)
@@ -240,14 +236,14 @@ void GFX::update() {
             }
         }
         // Reset dirty rects for this line
-        memset(&dirtyRects[y][0], false, 5);
+        memset(&screenDirtyRects[y][0], false, 5);
     }
 
     // Bottom framebuffer sector
     for(y = y - 256; y < 224; y = y + stepY) {
         int realY = y + 256;
         for(int rect = 0; rect < 5; rect++) {
-            if(dirtyRects[realY][rect]) {
+            if(screenDirtyRects[realY][rect]) {
                 int xStart = rect << 6;
                 int offset = 320 * y;
                 for(int x = 0; x < 64; x++)
@@ -257,7 +253,7 @@ void GFX::update() {
             }
         }
         // Reset dirty rects for this line
-        memset(&dirtyRects[realY][0], false, 5);
+        memset(&screenDirtyRects[realY][0], false, 5);
     }
 
     // End SPI transaction
@@ -290,139 +286,418 @@ void GFX::setAddressWindow(uint16_t x, uint16_t y, uint16_t width, uint16_t heig
     digitalWrite(GPIO_HX8357D_DC, HIGH);
 }
 
-int16_t GFX::cropToViewSize(int16_t* start, uint16_t* length, uint16_t viewSize) {
-    // Check if the line is completely outside the screen
-    if(*start >= viewSize) {
+int16_t GFX::cropToView(int16_t* start, uint16_t* length, int16_t viewStart, int16_t viewEnd) {
+    // Check if the line is completely outside the view (viewStart to viewEnd)
+    if(*start > viewEnd) {
         *start = 0;
         *length = 0;
         return -1;
     }
     int16_t end = *start + *length - 1;
-    if(end < 0) {
+    if(end < viewStart) {
         *start = 0;
         *length = 0;
         return -1;
     }
 
-    // If we get here, the line is at least partially on the screen.
-    // Check if it starts outside the screen and recalculate the length if necessary.
-    if(*start < 0) {
-        *length += *start;
-        *start = 0;
+    // If we get here, the line is at least partially in the view.
+    // Check if it starts outside the view and recalculate the length if necessary.
+    if(*start < viewStart) {
+        *length -= viewStart - *start;
+        *start = viewStart;
     }
 
-    // Check if the line ends outside the screen and recalculate the length if necessary.
-    *length = (end < viewSize) ? *length : (viewSize - *start);
+    // Check if the line ends outside the view and recalculate the length if necessary.
+    *length = (end <= viewEnd) ? *length : (viewEnd - *start + 1);
 
     // Return the end coordinate of the line
     return (*start + *length - 1);
 }
 
+// Integer division rounding towards negative infinity
+static inline int32_t floorDiv(int32_t a, int32_t b) {
+    int32_t q = a / b;
+    if((a % b != 0) && ((a < 0) != (b < 0)))
+        q--;
+    return q;
+}
+
+static int32_t bresenhamFirstStep(int32_t carries, int32_t dx, int32_t dy) {
+    // First step of a Bresenham line (err starting at dx / 2, decreasing by
+    // dy and increased by dx on each carry) after which the minor coordinate
+    // moved by at least carries pixels. The result is capped at dx + 1.
+    if(carries <= 0)
+        return 0;
+    int64_t step = ((int64_t)(carries - 1) * dx + dx / 2) / dy + 1;
+    return (step > dx + 1) ? dx + 1 : (int32_t)step;
+}
+
+// Surfaces don't track dirty rectangles: while one is the target, the marks
+// go here and are never read, so the drawing code doesn't need to check
+static uint8_t discardedDirtyRects[480][5];
+
+inline uint8_t* GFX::lineAddress(int16_t y) {
+    // Address of the first pixel of line y of the target
+    if(target != NULL)
+        return target->pixels + target->stride * y;
+    return screenBuffer[SCREENBUFFER_SECTOR_2(y)] + 320 * (y & 0xFF);
+}
+
 void GFX::fillScreen(uint8_t color) {
+    // Only the clipping rectangle is filled, if there is one. Surfaces are
+    // filled line by line, since their rows don't need to be contiguous.
+    if(target != NULL || clipRect.left > 0 || clipRect.top > 0 || clipRect.right < 319 || clipRect.bottom < 479) {
+        if(clipRect.left <= clipRect.right) {
+            for(int16_t y = clipRect.top; y <= clipRect.bottom; y++)
+                drawSpan(y, clipRect.left, clipRect.right, color);
+        }
+        return;
+    }
     memset(screenBuffer[0], color, 81920);
     memset(screenBuffer[1], color, 71680);
-    memset(dirtyRects, true, 2400);
+    memset(screenDirtyRects, true, 2400);
+}
+
+bool GFX::pushClipRect(int16_t x, int16_t y, uint16_t width, uint16_t height) {
+    // Save the current clipping rectangle and origin, then restrict drawing
+    // to the part of the rectangle inside the current clipping rectangle.
+    // The rectangle is relative to the origin. Returns false if the stack is
+    // full, leaving the clipping rectangle unchanged.
+    if(clipStackSize == CLIP_STACK_DEPTH)
+        return false;
+    clipStack[clipStackSize++] = clipRect;
+    int32_t left = (int32_t)x + clipRect.originX;
+    int32_t top = (int32_t)y + clipRect.originY;
+    int32_t right = left + width - 1;
+    int32_t bottom = top + height - 1;
+    if(left < clipRect.left) left = clipRect.left;
+    if(top < clipRect.top) top = clipRect.top;
+    if(right > clipRect.right) right = clipRect.right;
+    if(bottom > clipRect.bottom) bottom = clipRect.bottom;
+    if(left > right || top > bottom) {
+        // Nothing can be drawn: every "outside" test of the primitives fails
+        left = 32767;
+        top = 32767;
+        right = -32768;
+        bottom = -32768;
+    }
+    clipRect.left = left;
+    clipRect.top = top;
+    clipRect.right = right;
+    clipRect.bottom = bottom;
+    return true;
+}
+
+void GFX::popClipRect() {
+    // Restore the clipping rectangle and origin saved by pushClipRect
+    if(clipStackSize > 0)
+        clipRect = clipStack[--clipStackSize];
+}
+
+void GFX::setOrigin(int16_t x, int16_t y) {
+    // Screen position of the point (0, 0) for all the primitives. The
+    // origin is saved and restored with the clipping rectangle.
+    clipRect.originX = x;
+    clipRect.originY = y;
+}
+
+void GFX::resetClipRect(uint16_t width, uint16_t height) {
+    // Draw on the whole target, with the origin in its top left corner
+    clipRect.left = 0;
+    clipRect.top = 0;
+    clipRect.right = width - 1;
+    clipRect.bottom = height - 1;
+    clipRect.originX = 0;
+    clipRect.originY = 0;
+    clipStackSize = 0;
+    if(width == 0 || height == 0) {
+        // Nothing can be drawn (see pushClipRect)
+        clipRect.left = 32767;
+        clipRect.top = 32767;
+        clipRect.right = -32768;
+        clipRect.bottom = -32768;
+    }
+}
+
+bool GFX::createSurface(Surface* surface, uint16_t width, uint16_t height) {
+    // Allocate the pixels of a surface, which are not initialized. Returns
+    // false if the surface is bigger than the screen or can't be allocated.
+    surface->width = width;
+    surface->height = height;
+    surface->stride = width;
+    surface->pixels = NULL;
+    if(width > 320 || height > 480)
+        return false;
+    surface->pixels = (uint8_t*)malloc((uint32_t)width * height);
+    return surface->pixels != NULL;
+}
+
+void GFX::freeSurface(Surface* surface) {
+    if(target == surface)
+        setTarget(NULL);
+    free(surface->pixels);
+    surface->pixels = NULL;
+}
+
+bool GFX::setTarget(Surface* surface) {
+    // Draw into the surface, or into the screen buffer if surface is NULL.
+    // The clipping rectangle is reset to the whole target and the origin to
+    // its top left corner. Returns false if the surface is bigger than the
+    // screen, leaving the target unchanged.
+    if(surface != NULL && (surface->width > 320 || surface->height > 480))
+        return false;
+    target = surface;
+    if(surface == NULL) {
+        dirtyRects = screenDirtyRects;
+        resetClipRect(320, 480);
+    } else {
+        dirtyRects = discardedDirtyRects;
+        resetClipRect(surface->width, surface->height);
+    }
+    return true;
+}
+
+Surface* GFX::getTarget() {
+    return target;
+}
+
+void GFX::blitSurface(Surface* surface, int16_t x, int16_t y) {
+    blitSurfaceRows(surface, x, y, false, 0);
+}
+
+void GFX::blitSurface(Surface* surface, int16_t x, int16_t y, uint8_t transparentColor) {
+    blitSurfaceRows(surface, x, y, true, transparentColor);
+}
+
+void GFX::blitSurfaceRows(Surface* surface, int16_t x, int16_t y, bool transparent, uint8_t transparentColor) {
+    // Copy a surface to the target. Nothing is drawn if the surface is the target.
+    if(surface == target) return;
+    uint16_t width = surface->width;
+    uint16_t height = surface->height;
+    if(width == 0 || height == 0) return;
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right) return;
+    if(y > clipRect.bottom) return;
+    if(x + width - 1 < clipRect.left) return;
+    if(y + height - 1 < clipRect.top) return;
+
+    int16_t u = -x;
+    int16_t v = -y;
+    int16_t xEnd = cropToView(&x, &width, clipRect.left, clipRect.right);
+    int16_t yEnd = cropToView(&y, &height, clipRect.top, clipRect.bottom);
+    uint8_t* source = surface->pixels + surface->stride * (y + v) + x + u;
+
+    int r1 = DIRTY_RECT_X(x);
+    int r2 = DIRTY_RECT_X(xEnd);
+    for( ; y <= yEnd; y++, source += surface->stride) {
+        uint8_t* destination = lineAddress(y) + x;
+        if(!transparent) {
+            memcpy(destination, source, width);
+        } else {
+            uint8_t* s = source;
+            for(uint8_t* end = destination + width; destination < end; destination++, s++) {
+                if(*s != transparentColor)
+                    *destination = *s;
+            }
+        }
+        for(int i = r1; i <= r2; i++)
+            dirtyRects[y][i] = true;
+    }
 }
 
-void GFX::drawPixel(uint16_t x, uint16_t y, uint8_t color) {
-    // Set dirty rectangle
+void GFX::drawPixel(int16_t x, int16_t y, uint8_t color) {
+    drawClippedPixel(x + clipRect.originX, y + clipRect.originY, color);
+}
+
+void GFX::drawClippedPixel(int16_t x, int16_t y, uint8_t color) {
+    // Draw a pixel in screen coordinates if it is inside the clipping rectangle
+    if(x < clipRect.left || x > clipRect.right || y < clipRect.top || y > clipRect.bottom)
+        return;
     dirtyRects[y][DIRTY_RECT_X(x)] = true;
+    lineAddress(y)[x] = color;
+}
 
-    // Draw pixel
-    int sector = SCREENBUFFER_SECTOR_2(y);
-    if(sector)
-        y = y - 256;
-    int index = 320 * y + x;
-    screenBuffer[sector][index] = color;
+void GFX::drawPoints(const Point* points, uint16_t count, uint8_t color) {
+    // Points outside the clipping rectangle are skipped. A pixel that already
+    // has the right color doesn't need to be sent to the display again.
+    ClipRect view = clipRect;
+    for(int i = 0; i < count; i++) {
+        int16_t x = points[i].x + view.originX;
+        int16_t y = points[i].y + view.originY;
+        if(x < view.left || x > view.right || y < view.top || y > view.bottom)
+            continue;
+        uint8_t* pixel = lineAddress(y) + x;
+        if(*pixel != color) {
+            *pixel = color;
+            dirtyRects[y][DIRTY_RECT_X(x)] = true;
+        }
+    }
+}
+
+void GFX::movePoints(const Point* oldPoints, const Point* newPoints, uint16_t count, uint8_t color, uint8_t backgroundColor) {
+    // Erase the points that moved, then draw all of them: a point could
+    // move over the previous position of another one. Only pixels that still
+    // have the point color are erased, so anything drawn over them is kept.
+    ClipRect view = clipRect;
+    for(int i = 0; i < count; i++) {
+        if(oldPoints[i].x == newPoints[i].x && oldPoints[i].y == newPoints[i].y)
+            continue;
+        int16_t x = oldPoints[i].x + view.originX;
+        int16_t y = oldPoints[i].y + view.originY;
+        if(x < view.left || x > view.right || y < view.top || y > view.bottom)
+            continue;
+        uint8_t* pixel = lineAddress(y) + x;
+        if(*pixel == color) {
+            *pixel = backgroundColor;
+            dirtyRects[y][DIRTY_RECT_X(x)] = true;
+        }
+    }
+    drawPoints(newPoints, count, color);
 }
 
 void GFX::drawHorizontalLine(int16_t x, int16_t y, uint16_t width, uint8_t color) {
-    // Set dirty rectangles
-    int r1 = DIRTY_RECT_X(x);
-    int r2 = DIRTY_RECT_X(x + width - 1);
-    for(int i = r1; i <= r2; i++)
+    if(width == 0)
+        return;
+    x += clipRect.originX;
+    y += clipRect.originY;
+    drawClippedSpan(y, x, x + width - 1, color);
+}
+
+inline void GFX::drawSpan(int16_t y, int16_t x1, int16_t x2, uint8_t color) {
+    // Fill the pixels from x1 to x2 of an on-screen row, with x1 <= x2
+    // inside the screen: the caller already did the clipping
+    // Short spans touch one or two dirty rectangles: mark the ends without
+    // a loop, the cells between them only for long spans
+    int r1 = DIRTY_RECT_X(x1);
+    int r2 = DIRTY_RECT_X(x2);
+    dirtyRects[y][r1] = true;
+    dirtyRects[y][r2] = true;
+    for(int i = r1 + 1; i < r2; i++)
         dirtyRects[y][i] = true;
+    memset(lineAddress(y) + x1, color, x2 - x1 + 1);
+}
+
+void GFX::drawClippedSpan(int16_t y, int16_t x1, int16_t x2, uint8_t color) {
+    // Fill the pixels from x1 to x2 of row y that are inside the clipping rectangle
+    if(y < clipRect.top || y > clipRect.bottom)
+        return;
+    if(x1 < clipRect.left)
+        x1 = clipRect.left;
+    if(x2 > clipRect.right)
+        x2 = clipRect.right;
+    if(x1 <= x2)
+        drawSpan(y, x1, x2, color);
+}
 
-    // Draw line
-    int sector = SCREENBUFFER_SECTOR_2(y);
-    if(sector)
-        y = y - 256;
-    int offset = 320 * y + x; 
-    memset(screenBuffer[sector] + offset, color, width);
+void GFX::fillRowPair(int16_t y1, int16_t y2, int16_t x1, int16_t x2, uint8_t color, bool clip) {
+    // Fill the rows y1 and y2 (only once if they are the same) from x1 to x2.
+    // Clipping is done only if the whole shape isn't inside the clipping rectangle.
+    if(clip) {
+        if(x1 < clipRect.left)
+            x1 = clipRect.left;
+        if(x2 > clipRect.right)
+            x2 = clipRect.right;
+        if(x1 > x2)
+            return;
+        if(y1 >= clipRect.top && y1 <= clipRect.bottom)
+            drawSpan(y1, x1, x2, color);
+        if(y2 != y1 && y2 >= clipRect.top && y2 <= clipRect.bottom)
+            drawSpan(y2, x1, x2, color);
+    } else {
+        drawSpan(y1, x1, x2, color);
+        if(y2 != y1)
+            drawSpan(y2, x1, x2, color);
+    }
+}
+
+void GFX::outlineRow(int16_t y, int16_t left, int16_t right, int16_t inner, int16_t outer, uint8_t color, bool clip) {
+    // Draw the pixels of row y from left - outer to left - inner and from
+    // right + inner to right + outer. The segments are one or two pixels
+    // long on most rows; when inner is 0 the whole row is filled.
+    if(clip && (y < clipRect.top || y > clipRect.bottom))
+        return;
+    if(inner == 0) {
+        fillRowPair(y, y, left - outer, right + outer, color, clip);
+        return;
+    }
+    uint8_t* line = lineAddress(y);
+    for(int16_t u = inner; u <= outer; u++) {
+        int16_t x1 = left - u;
+        int16_t x2 = right + u;
+        if(!clip || (x1 >= clipRect.left && x1 <= clipRect.right)) {
+            line[x1] = color;
+            dirtyRects[y][DIRTY_RECT_X(x1)] = true;
+        }
+        if(!clip || (x2 >= clipRect.left && x2 <= clipRect.right)) {
+            line[x2] = color;
+            dirtyRects[y][DIRTY_RECT_X(x2)] = true;
+        }
+    }
 }
 
 void GFX::drawVerticalLine(int16_t x, int16_t y, uint16_t height, uint8_t color) {
+    if(height == 0)
+        return;
+    x += clipRect.originX;
+    y += clipRect.originY;
+    drawClippedColumn(x, y, y + height - 1, color);
+}
+
+void GFX::drawClippedColumn(int16_t x, int16_t y1, int16_t y2, uint8_t color) {
+    // Fill the pixels from y1 to y2 of column x that are inside the clipping rectangle
+    if(x < clipRect.left || x > clipRect.right)
+        return;
+    if(y1 < clipRect.top)
+        y1 = clipRect.top;
+    if(y2 > clipRect.bottom)
+        y2 = clipRect.bottom;
+    if(y1 <= y2)
+        drawColumn(x, y1, y2, color);
+}
+
+void GFX::drawColumn(int16_t x, int16_t y, int16_t y2, uint8_t color) {
+    // Fill the pixels from y to y2 of an on-screen column, with y <= y2
     // Set dirty rectangles
+    uint8_t (*dirty)[5] = dirtyRects;
     int r = DIRTY_RECT_X(x);
-    for(int i = y; i <= y + height - 1; i++)
-        dirtyRects[i][r] = true;
-
-    // Draw line
-    int16_t y2 = y + height - 1;
-    int startSector = SCREENBUFFER_SECTOR_2(y);
-    int endSector = SCREENBUFFER_SECTOR_2(y2);
-    if(startSector == endSector) {
-        if(startSector) {
-            y = y - 256;
-            y2 = y2 - 256;
-        }
-        for( ; y <= y2; y++)
-            screenBuffer[startSector][320 * y + x] = color;
-    } else {
-        y2 = y2 - 256;
-        for( ; y < 256; y++)
-            screenBuffer[0][320 * y + x] = color;
-        for(y = 0; y <= y2; y++)
-            screenBuffer[1][320 * y + x] = color;
+    for(int i = y; i <= y2; i++)
+        dirty[i][r] = true;
+
+    // Draw line, in two parts if it crosses the screen buffer sectors
+    uint16_t stride = (target != NULL) ? target->stride : 320;
+    while(y <= y2) {
+        int16_t end = (target == NULL && y < 256 && y2 >= 256) ? 255 : y2;
+        uint8_t* pixel = lineAddress(y) + x;
+        for( ; y <= end; y++, pixel += stride)
+            *pixel = color;
     }
 }
 
 void GFX::drawLine(int16_t xStart, int16_t yStart, int16_t xEnd, int16_t yEnd, uint8_t color) {
+    xStart += clipRect.originX;
+    yStart += clipRect.originY;
+    xEnd += clipRect.originX;
+    yEnd += clipRect.originY;
+
     // Check for horizontal/vertical line to use faster functions
     if(yStart == yEnd) {
-        // Check if the line is outside the screen
-        if(yStart < 0 || yStart >= 480)
-            return;
-
-        // Sort horizontal coordinates
-        if(xEnd < xStart) {
-            int16_t tmp;
-            tmp = xStart; xStart = xEnd; xEnd = tmp;
-        }
-
-        // Check if the line is outside the screen
-        if(xEnd < 0 || xStart >= 320)
-            return;
-        
-        // Draw line
-        uint16_t width = xEnd - xStart + 1;
-        cropToViewSize(&xStart, &width, 320);
-        drawHorizontalLine(xStart, yStart, width, color);
+        if(xEnd < xStart)
+            drawClippedSpan(yStart, xEnd, xStart, color);
+        else
+            drawClippedSpan(yStart, xStart, xEnd, color);
         return;
     } else if(xStart == xEnd) {
-        // Check if the line is outside the screen
-        if(xStart < 0 || xStart >= 320)
-            return;        
-
-        // Sort vertical coordinates
-        if(yEnd < yStart) {
-            int16_t tmp;
-            tmp = yStart; yStart = yEnd; yEnd = tmp;
-        }
-
-        // Check if the line is outside the screen
-        if(yEnd < 0 || yStart >= 480)
-            return;
-        
-        // Draw line
-        uint16_t height = yEnd - yStart + 1;
-        cropToViewSize(&yStart, &height, 480);
-        drawVerticalLine(xStart, yStart, height, color);
+        if(yEnd < yStart)
+            drawClippedColumn(xStart, yEnd, yStart, color);
+        else
+            drawClippedColumn(xStart, yStart, yEnd, color);
         return;
     }
 
-    // Bresenham's line algorithm
-    int16_t steep = abs(yEnd - yStart) > abs(xEnd - xStart);
+    // Bresenham's line algorithm, stepping along the major axis (x after the
+    // swap) and drawing the pixels with the same minor coordinate as one run
+    bool steep = abs(yEnd - yStart) > abs(xEnd - xStart);
     if (steep) {
         int16_t tmp;
         tmp = xStart; xStart = yStart; yStart = tmp;
@@ -434,31 +709,78 @@ void GFX::drawLine(int16_t xStart, int16_t yStart, int16_t xEnd, int16_t yEnd, u
         tmp = yStart; yStart = yEnd; yEnd = tmp;
     }
 
-    int16_t dx, dy;
-    dx = xEnd - xStart;
-    dy = abs(yEnd - yStart);
-
-    int16_t err = dx / 2;
-    int16_t yStep;
-
-    if (yStart < yEnd) {
-        yStep = 1;
-    } else {
-        yStep = -1;
-    }
+    int32_t dx = xEnd - xStart;
+    int32_t dy = abs(yEnd - yStart);
+    int32_t half = dx / 2;
+    int32_t yStep = (yStart < yEnd) ? 1 : -1;
+
+    // Clip before rasterising: find the first and last steps that are inside
+    // the clipping rectangle on both axes, so the pixels outside are never visited
+    int16_t xMin = steep ? clipRect.top : clipRect.left;
+    int16_t xMax = steep ? clipRect.bottom : clipRect.right;
+    int16_t yMin = steep ? clipRect.left : clipRect.top;
+    int16_t yMax = steep ? clipRect.right : clipRect.bottom;
+    int32_t first = (xStart < xMin) ? xMin - xStart : 0;
+    int32_t last = (xEnd > xMax) ? xMax - xStart : dx;
+    int32_t minCarries = (yStep > 0) ? yMin - yStart : yStart - yMax;
+    int32_t maxCarries = (yStep > 0) ? yMax - yStart : yStart - yMin;
+    int32_t step = bresenhamFirstStep(minCarries, dx, dy);
+    if(step > first)
+        first = step;
+    step = bresenhamFirstStep(maxCarries + 1, dx, dy) - 1;
+    if(step < last)
+        last = step;
+    if(first > last)
+        return;
 
-    for ( ; xStart<=xEnd; xStart++) {
-        if (steep) {
-            if(ONSCREEN(yStart, xStart))
-                drawPixel(yStart, xStart, color);
+    // Bresenham state at the first visible step, with err = a * dy + b
+    int64_t t = (int64_t)first * dy - half;
+    int32_t carries = (t <= 0) ? 0 : (int32_t)((t + dx - 1) / dx);
+    int32_t err = (int32_t)(half - (int64_t)first * dy + (int64_t)carries * dx);
+    int32_t a = err / dy;
+    int32_t b = err % dy;
+    int32_t q = dx / dy;
+    int32_t r = dx % dy;
+    int16_t x = xStart + first;
+    int16_t y = yStart + yStep * carries;
+    int32_t remaining = last - first + 1;
+
+    // Vertical runs step down the target, moving to the other sector after
+    // the last line of the first screen buffer sector
+    uint16_t stride = (target != NULL) ? target->stride : 320;
+    int16_t sectorEnd = (target != NULL) ? -1 : 255;
+    uint8_t (*dirty)[5] = dirtyRects;
+
+    while(remaining > 0) {
+        // The run lasts until err goes negative, and each run is q or q + 1
+        // pixels long, so no division is needed inside the loop
+        int32_t length = a + 1;
+        if(length > remaining)
+            length = remaining;
+        if(steep) {
+            // Vertical run in column y, from row x
+            uint8_t* pixel = lineAddress(x) + y;
+            int cell = DIRTY_RECT_X(y);
+            for(int16_t i = x; i < x + length; i++) {
+                *pixel = color;
+                dirty[i][cell] = true;
+                pixel = (i == sectorEnd) ? lineAddress(i + 1) + y : pixel + stride;
+            }
+        } else if(length == 1) {
+            // Near-diagonal lines have many single pixel runs
+            lineAddress(y)[x] = color;
+            dirty[y][DIRTY_RECT_X(x)] = true;
         } else {
-            if(ONSCREEN(xStart, yStart))
-                drawPixel(xStart, yStart, color);
+            drawSpan(y, x, x + length - 1, color);
         }
-        err -= dy;
-        if (err < 0) {
-            yStart += yStep;
-            err += dx;
+        x += length;
+        y += yStep;
+        remaining -= length;
+        b += r;
+        a = q - 1;
+        if(b >= dy) {
+            b -= dy;
+            a++;
         }
     }
 }
@@ -471,20 +793,21 @@ void GFX::drawRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, u
 }
 
 void GFX::drawFilledRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color) {
-    // Check if the rectangle is outside the screen
-    if(x >= 320 || y >= 480)
+    // Check if the rectangle is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right || y > clipRect.bottom)
         return;
-    if(x + width - 1 < 0)
+    if(x + width - 1 < clipRect.left)
         return;
-    if(y + height - 1 < 0)
+    if(y + height - 1 < clipRect.top)
         return;
 
     // Draw the filled rectangle
-    int16_t y2;
-    cropToViewSize(&x, &width, 320);
-    y2 = cropToViewSize(&y, &height, 480);
+    int16_t x2 = cropToView(&x, &width, clipRect.left, clipRect.right);
+    int16_t y2 = cropToView(&y, &height, clipRect.top, clipRect.bottom);
     for( ; y <= y2; y++)
-        drawHorizontalLine(x, y, width, color);
+        drawSpan(y, x, x2, color);
 }
 
 void GFX::drawTriangle(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2, uint8_t color) {
@@ -493,9 +816,50 @@ void GFX::drawTriangle(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2,
     drawLine(x2, y2, x0, y0, color);
 }
 
+// Edge of a filled triangle or polygon, walked one row at a time. x is the first pixel
+// column at or right of the edge: x = ceil(x0 + (y - y0) * dx / dy), with the
+// exact fraction kept in remainder, so no division is needed per row.
+struct ScanEdge {
+    int32_t x;
+    int32_t remainder;      // x * dy - (x0 * dy + (y - y0) * dx), 0 <= remainder < dy
+    int32_t step;           // floor(dx / dy)
+    int32_t stepRemainder;  // dx - step * dy
+    int32_t dy;
+};
+
+static void setupScanEdge(ScanEdge* e, int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t y) {
+    // Edge from (x0, y0) to (x1, y1) with y0 < y1, starting at row y >= y0
+    int32_t dx = x1 - x0;
+    e->dy = y1 - y0;
+    e->step = floorDiv(dx, e->dy);
+    e->stepRemainder = dx - e->step * e->dy;
+    if(y == y0) {
+        e->x = x0;
+        e->remainder = 0;
+    } else {
+        // Rows above the screen are skipped at once
+        int64_t n = (int64_t)(y - y0) * dx;
+        int32_t q = (n >= 0) ? (n + e->dy - 1) / e->dy : -((-n) / e->dy);
+        e->x = x0 + q;
+        e->remainder = (int64_t)q * e->dy - n;
+    }
+}
+
+static inline void stepScanEdge(ScanEdge* e) {
+    // Branch free: carry is -1 when the remainder wraps, 0 otherwise
+    e->remainder -= e->stepRemainder;
+    int32_t carry = e->remainder >> 31;
+    e->remainder += e->dy & carry;
+    e->x += e->step - carry;
+}
+
 void GFX::drawFilledTriangle(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2, uint8_t color) {
-    int dx01, dx02, dx12, dy01, dy02, dy12;
-    int u01, u02, u12;
+    // Pixels are sampled at their coordinates with the top-left fill rule:
+    // a pixel on a left or top edge is drawn, one on a right or bottom edge
+    // isn't, so triangles sharing an edge never overlap or leave gaps
+    x0 += clipRect.originX; y0 += clipRect.originY;
+    x1 += clipRect.originX; y1 += clipRect.originY;
+    x2 += clipRect.originX; y2 += clipRect.originY;
 
     // Sort vertices by y value
     if(y0 > y1) {
@@ -514,92 +878,391 @@ void GFX::drawFilledTriangle(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16
         tmp = x1; x1 = x2; x2 = tmp;
     }
 
-    // Set up long side (0 => 2)
-    dx02 = x2 - x0;
-    dy02 = y2 - y0;
-    u02 = x0 * dy02;
-
-    // Upper triangle
-    if(y1 > y0) {
-        // Set up upper side (0 => 1)
-        dx01 = x1 - x0;
-        dy01 = y1 - y0;
-        u01 = x0 * dy01;
-
-        // Draw upper triangle
-        for(int y=y0; y<y1; y++) {
-            int16_t xStart = u01 / dy01;
-            int16_t xEnd = u02 / dy02;
-            if(xEnd > xStart) {
-                if(y >= 0 && y < 480) {
-                    uint16_t width = xEnd - xStart + 1;
-                    cropToViewSize(&xStart, &width, 320);
-                    drawHorizontalLine(xStart, y, width, color);
-                }
-            } else {
-                if(y >= 0 && y < 480) {
-                    uint16_t width = xStart - xEnd + 1;
-                    cropToViewSize(&xEnd, &width, 320);
-                    drawHorizontalLine(xEnd, y, width, color);
-                }
+    // Check if the triangle is outside the clipping rectangle or has no area
+    int16_t xMin = (x0 < x1) ? x0 : x1;
+    int16_t xMax = (x0 > x1) ? x0 : x1;
+    if(x2 < xMin) xMin = x2;
+    if(x2 > xMax) xMax = x2;
+    if(y0 > clipRect.bottom || y2 <= clipRect.top || xMin > clipRect.right || xMax <= clipRect.left)
+        return;
+    int32_t cross = (int32_t)(x1 - x0) * (y2 - y0) - (int32_t)(x2 - x0) * (y1 - y0);
+    if(cross == 0)
+        return;
+
+    // Rows from y0 to y2 - 1, clipped once. The long edge (0 => 2) is on the
+    // left if the middle vertex is on its right (cross > 0).
+    int16_t clipLeft = clipRect.left;
+    int16_t clipRight = clipRect.right;
+    bool clipX = (xMin < clipLeft || xMax > clipRight + 1);
+    bool longEdgeLeft = (cross > 0);
+    int16_t yStart = (y0 > clipRect.top) ? y0 : clipRect.top;
+    int16_t yEnd = (y2 <= clipRect.bottom) ? y2 : clipRect.bottom + 1;
+    int16_t yMiddle = (y1 < yStart) ? yStart : ((y1 > yEnd) ? yEnd : y1);
+    ScanEdge longEdge, shortEdge;
+    setupScanEdge(&longEdge, x0, y0, x2, y2, yStart);
+
+    for(int half = 0; half < 2; half++) {
+        int16_t y = (half == 0) ? yStart : yMiddle;
+        int16_t yStop = (half == 0) ? yMiddle : yEnd;
+        if(y >= yStop)
+            continue;
+        if(half == 0)
+            setupScanEdge(&shortEdge, x0, y0, x1, y1, y);
+        else
+            setupScanEdge(&shortEdge, x1, y1, x2, y2, y);
+        ScanEdge* left = longEdgeLeft ? &longEdge : &shortEdge;
+        ScanEdge* right = longEdgeLeft ? &shortEdge : &longEdge;
+
+        for( ; y < yStop; y++) {
+            int32_t xStart = left->x;
+            int32_t xEnd = right->x - 1;
+            if(clipX) {
+                if(xStart < clipLeft)
+                    xStart = clipLeft;
+                if(xEnd > clipRight)
+                    xEnd = clipRight;
             }
+            if(xStart <= xEnd)
+                drawSpan(y, xStart, xEnd, color);
+            stepScanEdge(&longEdge);
+            stepScanEdge(&shortEdge);
+        }
+    }
+}
+
+// Polygon edge in the edge table, sorted by top row
+struct PolygonEdge {
+    int16_t x0;
+    int16_t y0;         // Top row
+    int16_t x1;
+    int16_t y1;         // First row below the edge
+    int8_t winding;     // +1 going down, -1 going up
+};
+
+// Polygon edge crossing the current row
+struct ActiveEdge {
+    ScanEdge edge;
+    int16_t y1;
+    int8_t winding;
+};
+
+// Edges of one or more polygons to be filled together. Small tables don't
+// need to allocate memory.
+struct EdgeTable {
+    PolygonEdge stackEdges[POLYGON_STACK_EDGES];
+    ActiveEdge stackActive[POLYGON_STACK_EDGES];
+    PolygonEdge* edges;
+    ActiveEdge* active;
+    uint16_t count;
+    int16_t xMin;
+    int16_t xMax;
+    int16_t yMin;
+    int16_t yMax;
+};
+
+static bool beginEdgeTable(EdgeTable* table, uint16_t capacity) {
+    // Returns false if the table can't be allocated
+    table->edges = table->stackEdges;
+    table->active = table->stackActive;
+    if(capacity > POLYGON_STACK_EDGES) {
+        table->active = (ActiveEdge*)malloc(capacity * (sizeof(ActiveEdge) + sizeof(PolygonEdge)));
+        if(table->active == NULL)
+            return false;
+        table->edges = (PolygonEdge*)(table->active + capacity);
+    }
+    table->count = 0;
+    table->xMin = 32767;
+    table->xMax = -32768;
+    table->yMin = 32767;
+    table->yMax = -32768;
+    return true;
+}
+
+static void endEdgeTable(EdgeTable* table) {
+    if(table->active != table->stackActive)
+        free(table->active);
+}
+
+static void addPolygonEdge(EdgeTable* table, const Point* a, const Point* b) {
+    // Horizontal edges are skipped
+    if(a->y == b->y)
+        return;
+    PolygonEdge edge;
+    if(a->y < b->y) {
+        edge.x0 = a->x; edge.y0 = a->y; edge.x1 = b->x; edge.y1 = b->y;
+        edge.winding = 1;
+    } else {
+        edge.x0 = b->x; edge.y0 = b->y; edge.x1 = a->x; edge.y1 = a->y;
+        edge.winding = -1;
+    }
+    if(edge.x0 < table->xMin) table->xMin = edge.x0;
+    if(edge.x1 < table->xMin) table->xMin = edge.x1;
+    if(edge.x0 > table->xMax) table->xMax = edge.x0;
+    if(edge.x1 > table->xMax) table->xMax = edge.x1;
+    if(edge.y0 < table->yMin) table->yMin = edge.y0;
+    if(edge.y1 > table->yMax) table->yMax = edge.y1;
+    table->edges[table->count++] = edge;
+}
 
-            // Next line
-            u02 = u02 + dx02;
-            u01 = u01 + dx01;
+static void sortEdgeTable(EdgeTable* table) {
+    // Sort the edges by top row. Shell sort: small polygons only do the last
+    // pass, an insertion sort, and polylines with many edges avoid its
+    // quadratic cost.
+    static const uint8_t gaps[] = {57, 23, 10, 4, 1};
+    PolygonEdge* edges = table->edges;
+    for(int g = 0; g < 5; g++) {
+        int gap = gaps[g];
+        for(int i = gap; i < table->count; i++) {
+            PolygonEdge edge = edges[i];
+            int j = i;
+            for( ; j >= gap && edges[j - gap].y0 > edge.y0; j -= gap)
+                edges[j] = edges[j - gap];
+            edges[j] = edge;
         }
     }
+}
 
-    // Lower triangle
-    if(y2 > y1) {
-        // Set up lower side (1 => 2)
-        dx12 = x2 - x1;
-        dy12 = y2 - y1;
-        u12 = x1 * dy12;
+static void addConvexPolygon(EdgeTable* table, const Point* points, uint16_t count) {
+    // Add the polygon with the same orientation as all the others, so that
+    // overlapping polygons filled with FILL_NONZERO give their union
+    int32_t area = 0;
+    for(int i = 0; i < count; i++) {
+        const Point* a = &points[i];
+        const Point* b = &points[(i + 1 < count) ? i + 1 : 0];
+        area += (int32_t)a->x * b->y - (int32_t)b->x * a->y;
+    }
+    if(area == 0)
+        return;
+    for(int i = 0; i < count; i++) {
+        const Point* a = &points[i];
+        const Point* b = &points[(i + 1 < count) ? i + 1 : 0];
+        if(area > 0)
+            addPolygonEdge(table, a, b);
+        else
+            addPolygonEdge(table, b, a);
+    }
+}
 
-        // Draw lower triangle
-        for(int y=y1; y<=y2; y++) {
-            int16_t xStart = u12 / dy12;
-            int16_t xEnd = u02 / dy02;
-            if(xEnd > xStart) {
-                if(y >= 0 && y < 480) {
-                    uint16_t width = xEnd - xStart + 1;
-                    cropToViewSize(&xStart, &width, 320);
-                    drawHorizontalLine(xStart, y, width, color);
-                }
-            } else {
-                if(y >= 0 && y < 480) {
-                    uint16_t width = xStart - xEnd + 1;
-                    cropToViewSize(&xEnd, &width, 320);
-                    drawHorizontalLine(xEnd, y, width, color);
-                }
+void GFX::fillEdgeTable(EdgeTable* table, uint8_t color, uint8_t fillRule) {
+    // Scanline fill with the sorted edge table and an active edge list. Pixels
+    // are sampled at their coordinates with the top-left rule: a pixel on a
+    // left or top edge is drawn, one on a right or bottom edge isn't, so
+    // polygons sharing an edge never overlap. The edges are relative to the origin.
+    PolygonEdge* edges = table->edges;
+    ActiveEdge* active = table->active;
+    uint16_t edgeCount = table->count;
+    int16_t originX = clipRect.originX;
+    int16_t originY = clipRect.originY;
+    int16_t xMin = table->xMin + originX;
+    int16_t xMax = table->xMax + originX;
+    int16_t yMin = table->yMin + originY;
+    int16_t yMax = table->yMax + originY;
+
+    // Check if the polygons are outside the clipping rectangle, then clip the rows once
+    if(edgeCount == 0 || yMin > clipRect.bottom || yMax <= clipRect.top || xMin > clipRect.right || xMax < clipRect.left)
+        return;
+    sortEdgeTable(table);
+    for(int i = 0; i < edgeCount; i++) {
+        edges[i].x0 += originX;
+        edges[i].y0 += originY;
+        edges[i].x1 += originX;
+        edges[i].y1 += originY;
+    }
+    int16_t clipLeft = clipRect.left;
+    int16_t clipRight = clipRect.right;
+    bool clipX = (xMin < clipLeft || xMax > clipRight);
+    int16_t yStart = (yMin > clipRect.top) ? yMin : clipRect.top;
+    int16_t yEnd = (yMax <= clipRect.bottom) ? yMax : clipRect.bottom + 1;
+    uint16_t nextEdge = 0;
+    uint16_t activeCount = 0;
+
+    for(int16_t y = yStart; y < yEnd; y++) {
+        // Remove the edges that ended and step the others
+        uint16_t kept = 0;
+        for(int i = 0; i < activeCount; i++) {
+            if(active[i].y1 > y) {
+                if(kept != i)
+                    active[kept] = active[i];
+                stepScanEdge(&active[kept].edge);
+                kept++;
             }
+        }
+        activeCount = kept;
+
+        // Add the edges that start on this row, or above the screen
+        for( ; nextEdge < edgeCount && edges[nextEdge].y0 <= y; nextEdge++) {
+            PolygonEdge* edge = &edges[nextEdge];
+            if(edge->y1 > y) {
+                setupScanEdge(&active[activeCount].edge, edge->x0, edge->y0, edge->x1, edge->y1, y);
+                active[activeCount].y1 = edge->y1;
+                active[activeCount].winding = edge->winding;
+                activeCount++;
+            }
+        }
 
-            // Next line
-            u02 = u02 + dx02;
-            u12 = u12 + dx12;
+        // Sort the active edges by x. The order changes only where edges
+        // cross, so the insertion sort is almost always a single pass.
+        for(int i = 1; i < activeCount; i++) {
+            if(active[i].edge.x < active[i - 1].edge.x) {
+                ActiveEdge edge = active[i];
+                int j = i;
+                for( ; j > 0 && active[j - 1].edge.x > edge.edge.x; j--)
+                    active[j] = active[j - 1];
+                active[j] = edge;
+            }
         }
-    } else {
-        // y1 == y2
-        int16_t xStart = x1;
-        int16_t xEnd = x2;
-        if(xEnd > xStart) {
-            if(y1 >= 0 && y1 < 480) {
-                uint16_t width = xEnd - xStart + 1;
-                cropToViewSize(&xStart, &width, 320);
-                drawHorizontalLine(xStart, y1, width, color);
+
+        // Fill between the crossings that enter and leave the inside. With
+        // FILL_NONZERO, overlapping polygons give a single span per row.
+        int winding = 0;
+        int32_t xStart = 0;
+        for(int i = 0; i < activeCount; i++) {
+            bool wasInside = (winding != 0);
+            if(fillRule == FILL_NONZERO)
+                winding += active[i].winding;
+            else
+                winding ^= 1;
+            if(wasInside == (winding != 0))
+                continue;
+            if(!wasInside) {
+                xStart = active[i].edge.x;
+                continue;
             }
-        } else {
-            if(y1 >= 0 && y1 < 480) {
-                uint16_t width = xStart - xEnd + 1;
-                cropToViewSize(&xEnd, &width, 320);
-                drawHorizontalLine(xEnd, y1, width, color);
+            int32_t x1 = xStart;
+            int32_t x2 = active[i].edge.x - 1;
+            if(clipX) {
+                if(x1 < clipLeft)
+                    x1 = clipLeft;
+                if(x2 > clipRight)
+                    x2 = clipRight;
             }
+            if(x1 <= x2)
+                drawSpan(y, x1, x2, color);
+        }
+    }
+}
+
+void GFX::drawFilledPolygon(const Point* points, uint16_t count, uint8_t color, uint8_t fillRule) {
+    // fillRule is FILL_EVEN_ODD or FILL_NONZERO
+    if(count < 3)
+        return;
+    EdgeTable table;
+    if(!beginEdgeTable(&table, count))
+        return;
+    for(int i = 0; i < count; i++)
+        addPolygonEdge(&table, &points[i], &points[(i + 1 < count) ? i + 1 : 0]);
+    fillEdgeTable(&table, color, fillRule);
+    endEdgeTable(&table);
+}
+
+static void addThickSegment(EdgeTable* table, int16_t xStart, int16_t yStart, int16_t xEnd, int16_t yEnd, float halfWidth, Point* corners) {
+    // Add the rectangle covering the segment, extended by half a pixel at
+    // both ends so that the end points are drawn, and return its corners.
+    // Corners 0 and 1 are on one side of the segment, 3 and 2 on the other.
+    float dx = xEnd - xStart;
+    float dy = yEnd - yStart;
+    float length = sqrtf(dx * dx + dy * dy);
+    float ux = 1, uy = 0, extension = halfWidth;
+    if(length > 0) {
+        ux = dx / length;
+        uy = dy / length;
+        extension = 0.5;
+    }
+
+    // Pixel centres are at integer coordinates: move the segment to the
+    // middle of its pixels, so that even and odd widths are both exact
+    float ax = xStart + 0.5 - ux * extension;
+    float ay = yStart + 0.5 - uy * extension;
+    float bx = xEnd + 0.5 + ux * extension;
+    float by = yEnd + 0.5 + uy * extension;
+    float nx = -uy * halfWidth;
+    float ny = ux * halfWidth;
+    corners[0].x = floorf(ax + nx); corners[0].y = floorf(ay + ny);
+    corners[1].x = floorf(bx + nx); corners[1].y = floorf(by + ny);
+    corners[2].x = floorf(bx - nx); corners[2].y = floorf(by - ny);
+    corners[3].x = floorf(ax - nx); corners[3].y = floorf(ay - ny);
+    addConvexPolygon(table, corners, 4);
+}
+
+void GFX::drawThickLine(int16_t xStart, int16_t yStart, int16_t xEnd, int16_t yEnd, uint8_t width, uint8_t color) {
+    if(width <= 1) {
+        drawLine(xStart, yStart, xEnd, yEnd, color);
+        return;
+    }
+    EdgeTable table;
+    Point corners[4];
+    if(!beginEdgeTable(&table, 4))
+        return;
+    addThickSegment(&table, xStart, yStart, xEnd, yEnd, width * 0.5, corners);
+    fillEdgeTable(&table, color, FILL_NONZERO);
+    endEdgeTable(&table);
+}
+
+void GFX::drawPolyline(const Point* points, uint16_t count, uint8_t width, uint8_t color) {
+    // The segments are joined with bevels. All the segments and joins are
+    // filled together as one non-zero polygon, so every row is written once.
+    if(count < 2)
+        return;
+    if(width <= 1) {
+        for(int i = 0; i + 1 < count; i++)
+            drawLine(points[i].x, points[i].y, points[i + 1].x, points[i + 1].y, color);
+        return;
+    }
+    // Each segment adds 4 edges and each join 3. The edge table can't hold
+    // more than 65535 edges, so polylines of more than 9363 points aren't drawn.
+    uint32_t capacity = 4 * (uint32_t)(count - 1) + 3 * (uint32_t)(count - 2);
+    if(capacity > 0xFFFF)
+        return;
+    EdgeTable table;
+    if(!beginEdgeTable(&table, capacity))
+        return;
+    Point previous[4];
+    Point corners[4];
+    for(int i = 0; i + 1 < count; i++) {
+        addThickSegment(&table, points[i].x, points[i].y, points[i + 1].x, points[i + 1].y, width * 0.5, corners);
+        if(i > 0) {
+            // Bevel join: fill the gap between the end of the previous
+            // segment and the start of this one on the outer side of the
+            // turn. The inner side is already covered by the segments.
+            int32_t turn = (int32_t)(points[i].x - points[i - 1].x) * (points[i + 1].y - points[i].y) -
+                    (int32_t)(points[i].y - points[i - 1].y) * (points[i + 1].x - points[i].x);
+            Point join[3];
+            join[0] = points[i];
+            join[1] = (turn > 0) ? previous[2] : previous[1];
+            join[2] = (turn > 0) ? corners[3] : corners[0];
+            addConvexPolygon(&table, join, 3);
         }
+        memcpy(previous, corners, sizeof(corners));
     }
+    fillEdgeTable(&table, color, FILL_NONZERO);
+    endEdgeTable(&table);
 }
 
 void GFX::drawCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color) {
+    x += clipRect.originX;
+    y += clipRect.originY;
+    uint8_t* table = getCircleTable(radius);
+    if(table != NULL) {
+        // Check if the circle is outside the clipping rectangle
+        if(x - radius > clipRect.right || x + radius < clipRect.left || y - radius > clipRect.bottom || y + radius < clipRect.top)
+            return;
+        bool clip = (x - radius < clipRect.left || x + radius > clipRect.right || y - radius < clipRect.top || y + radius > clipRect.bottom);
+
+        // The outline of row d goes from the end of the row above (d + 1)
+        // to the end of row d, or is just the last pixel if they are equal
+        for(int16_t d = 0; d <= radius; d++) {
+            int16_t outer = table[d];
+            int16_t inner = (d < radius) ? table[d + 1] + 1 : 0;
+            if(inner > outer)
+                inner = outer;
+            outlineRow(y - d, x, x, inner, outer, color, clip);
+            if(d != 0)
+                outlineRow(y + d, x, x, inner, outer, color, clip);
+        }
+        return;
+    }
+
+    // Radius too big for the tables: use the midpoint algorithm
     int16_t px = radius;
     int16_t py = 0;
     int16_t dx = 1 - 2 * radius;
@@ -607,14 +1270,14 @@ void GFX::drawCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color) {
     int16_t err = 0;
 
     while(px >= py) {
-        if(ONSCREEN(x + px, y + py)) drawPixel(x + px, y + py, color);
-        if(ONSCREEN(x + py, y + px)) drawPixel(x + py, y + px, color);
-        if(ONSCREEN(x - py, y + px)) drawPixel(x - py, y + px, color);
-        if(ONSCREEN(x - px, y + py)) drawPixel(x - px, y + py, color);
-        if(ONSCREEN(x - px, y - py)) drawPixel(x - px, y - py, color);
-        if(ONSCREEN(x - py, y - px)) drawPixel(x - py, y - px, color);
-        if(ONSCREEN(x + py, y - px)) drawPixel(x + py, y - px, color);
-        if(ONSCREEN(x + px, y - py)) drawPixel(x + px, y - py, color);
+        drawClippedPixel(x + px, y + py, color);
+        drawClippedPixel(x + py, y + px, color);
+        drawClippedPixel(x - py, y + px, color);
+        drawClippedPixel(x - px, y + py, color);
+        drawClippedPixel(x - px, y - py, color);
+        drawClippedPixel(x - py, y - px, color);
+        drawClippedPixel(x + py, y - px, color);
+        drawClippedPixel(x + px, y - py, color);
 
         py++;
         err += dy;
@@ -628,6 +1291,23 @@ void GFX::drawCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color) {
 }
 
 void GFX::drawFilledCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color) {
+    // Check if the circle is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x - radius > clipRect.right || x + radius < clipRect.left || y - radius > clipRect.bottom || y + radius < clipRect.top)
+        return;
+    bool clip = (x - radius < clipRect.left || x + radius > clipRect.right || y - radius < clipRect.top || y + radius > clipRect.bottom);
+
+    uint8_t* table = getCircleTable(radius);
+    if(table != NULL) {
+        for(int16_t d = 0; d <= radius; d++)
+            fillRowPair(y - d, y + d, x - table[d], x + table[d], color, clip);
+        return;
+    }
+
+    // Midpoint algorithm. Each step gives an inner row pair (y +/- py, half
+    // width px); an outer row pair (y +/- px, half width py) is final only
+    // when px is about to change, so every row is filled exactly once.
     int16_t px = radius;
     int16_t py = 0;
     int16_t dx = 1 - 2 * radius;
@@ -635,163 +1315,897 @@ void GFX::drawFilledCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color)
     int16_t err = 0;
 
     while(px >= py) {
-        int16_t xStart, yStart;
-        uint16_t width;
-        
-        xStart = x - px; yStart = y + py; width = 2 * px + 1;
-        if(yStart >= 0 && yStart < 480) {
-            cropToViewSize(&xStart, &width, 320);
-            drawHorizontalLine(xStart, yStart, width, color);
-        }
-        xStart = x - py; yStart = y + px; width = 2 * py + 1;
-        if(yStart >= 0 && yStart < 480) {
-            cropToViewSize(&xStart, &width, 320);
-            drawHorizontalLine(xStart, yStart, width, color);
-        }
-        xStart = x - px; yStart = y - py; width = 2 * px + 1;
-        if(yStart >= 0 && yStart < 480) {
-            cropToViewSize(&xStart, &width, 320);
-            drawHorizontalLine(xStart, yStart, width, color);
-        }
-        xStart = x - py; yStart = y - px; width = 2 * py + 1;
-        if(yStart >= 0 && yStart < 480) {
-            cropToViewSize(&xStart, &width, 320);
-            drawHorizontalLine(xStart, yStart, width, color);
-        }
+        fillRowPair(y - py, y + py, x - px, x + px, color, clip);
 
-        py++;
         err += dy;
         dy += 2;
         if(2 * err + dx > 0) {
+            // Skip the outer rows already filled as inner rows on the diagonal
+            if(px > py)
+                fillRowPair(y - px, y + px, x - py, x + py, color, clip);
             px--;
             err += dx;
             dx += 2;
         }
+        py++;
     }
 }
 
-void GFX::drawBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height) {
-    // Check if bitmap is outside the screen
-    if(x >= 320) return;
-    if(y >= 480) return;
-    if(x + width - 1 < 0) return;
-    if(y + height - 1 < 0) return;
-
-    // Offset to get the bitmap pixels
-    int16_t uOffset = -x;
-    int16_t vOffset = -y;
+void GFX::setCircleTableRadius(uint8_t maxRadius) {
+    // Circles up to maxRadius are drawn from tables of row half widths, that
+    // take (maxRadius + 1) * (maxRadius + 2) / 2 bytes. 0 disables the tables.
+    free(circleTable);
+    circleTable = NULL;
+    circleTableRadius = (maxRadius < 255) ? maxRadius : 254;
+}
 
-    // Calculate the visible part of the bitmap
-    uint16_t bitmapWidth = width;
-    cropToViewSize(&x, &width, 320);
-    int16_t yEnd = cropToViewSize(&y, &height, 480);
+uint8_t* GFX::getCircleTable(uint16_t radius) {
+    // Return the half widths of the rows of a circle, from the center row to
+    // the top row, building the table the first time. Returns NULL if the
+    // radius is too big or there isn't enough memory.
+    if(radius > circleTableRadius || circleTableRadius == 0)
+        return NULL;
+    if(circleTable == NULL) {
+        uint16_t size = (circleTableRadius + 1) * (circleTableRadius + 2) / 2;
+        circleTable = (uint8_t*)malloc(size);
+        if(circleTable == NULL) {
+            circleTableRadius = 0;
+            return NULL;
+        }
+        memset(circleTable, 0xFF, size);    // 0xFF => Table not built yet
+    }
 
-    // Copy the bitmap to screen buffer line by line
-    uint16_t u = x + uOffset;
-    uint16_t v = y + vOffset;
-    int r1 = DIRTY_RECT_X(x);
-    int r2 = DIRTY_RECT_X(x + width - 1);
-    for( ; y <= yEnd ; y++, v++) {
-        int bitmapOffset = bitmapWidth * v + u;
-        if(SCREENBUFFER_SECTOR(y)) {
-            int ysb = y - 256;
-            int screenBufferOffset = 320 * ysb + x;
-            memcpy(screenBuffer[1] + screenBufferOffset, bitmap + bitmapOffset, width);
-        } else {
-            int screenBufferOffset = 320 * y + x;
-            memcpy(screenBuffer[0] + screenBufferOffset, bitmap + bitmapOffset, width);
+    uint8_t* table = circleTable + radius * (radius + 1) / 2;
+    if(table[0] == 0xFF) {
+        // Same midpoint algorithm of drawCircle and drawFilledCircle
+        int16_t px = radius;
+        int16_t py = 0;
+        int16_t dx = 1 - 2 * radius;
+        int16_t dy = 1;
+        int16_t err = 0;
+        while(px >= py) {
+            table[py] = px;
+            err += dy;
+            dy += 2;
+            if(2 * err + dx > 0) {
+                if(px > py)
+                    table[px] = py;
+                px--;
+                err += dx;
+                dx += 2;
+            }
+            py++;
         }
-        for(int i = r1; i <= r2; i++)
-            dirtyRects[y][i] = true;
     }
+    return table;
+}
+
+// Half widths of the rows of an ellipse, from the center row to the top row.
+// A pixel is inside if its center is inside the ellipse with radii
+// radiusX + 0.5 and radiusY + 0.5:
+// 4 * w^2 * (2 * radiusY + 1)^2 + 4 * d^2 * (2 * radiusX + 1)^2 <= (2 * radiusX + 1)^2 * (2 * radiusY + 1)^2
+// The half width w only shrinks going away from the center row, so it is
+// updated incrementally.
+struct EllipseRows {
+    int64_t a;          // (2 * radiusX + 1)^2
+    int64_t b;          // (2 * radiusY + 1)^2
+    int64_t limit;
+    int64_t wTerm;      // 4 * w^2 * b
+    int64_t dTerm;      // 4 * d^2 * a
+    int16_t w;
+    int16_t d;
+};
 
+static void setupEllipseRows(EllipseRows* e, uint16_t radiusX, uint16_t radiusY) {
+    e->a = (2 * (int64_t)radiusX + 1) * (2 * (int64_t)radiusX + 1);
+    e->b = (2 * (int64_t)radiusY + 1) * (2 * (int64_t)radiusY + 1);
+    e->limit = e->a * e->b;
+    e->wTerm = 4 * (int64_t)radiusX * radiusX * e->b;
+    e->dTerm = 0;
+    e->w = radiusX;
+    e->d = 0;
 }
 
-void GFX::drawTransparentBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor) {
-    // Check if bitmap is outside the screen
-    if(x >= 320) return;
-    if(y >= 480) return;
-    if(x + width - 1 < 0) return;
-    if(y + height - 1 < 0) return;
+static int16_t nextEllipseRow(EllipseRows* e) {
+    // Return the half width of row d, then move to row d + 1
+    while(e->w > 0 && e->wTerm + e->dTerm > e->limit) {
+        // (w - 1)^2 = w^2 - 2 * w + 1
+        e->wTerm -= 4 * (2 * e->w - 1) * e->b;
+        e->w--;
+    }
+    // (d + 1)^2 = d^2 + 2 * d + 1
+    e->dTerm += 4 * (2 * e->d + 1) * e->a;
+    e->d++;
+    return e->w;
+}
 
-    // Offset to get the bitmap pixels
-    int16_t uOffset = -x;
-    int16_t vOffset = -y;
+void GFX::drawEllipse(int16_t x, int16_t y, uint16_t radiusX, uint16_t radiusY, uint8_t color) {
+    // Check if the ellipse is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x - radiusX > clipRect.right || x + radiusX < clipRect.left || y - radiusY > clipRect.bottom || y + radiusY < clipRect.top)
+        return;
+    bool clip = (x - radiusX < clipRect.left || x + radiusX > clipRect.right || y - radiusY < clipRect.top || y + radiusY > clipRect.bottom);
+
+    // The outline of row d goes from the end of row d + 1 to the end of row d
+    EllipseRows rows;
+    setupEllipseRows(&rows, radiusX, radiusY);
+    int16_t outer = nextEllipseRow(&rows);
+    for(int16_t d = 0; d <= radiusY; d++) {
+        int16_t next = (d < radiusY) ? nextEllipseRow(&rows) : -1;
+        int16_t inner = (next + 1 < outer) ? next + 1 : outer;
+        outlineRow(y - d, x, x, inner, outer, color, clip);
+        if(d != 0)
+            outlineRow(y + d, x, x, inner, outer, color, clip);
+        outer = next;
+    }
+}
 
-    // Calculate the visible part of the bitmap
-    uint16_t bitmapWidth = width;
-    int16_t xEnd = cropToViewSize(&x, &width, 320);
-    int16_t yEnd = cropToViewSize(&y, &height, 480);
+void GFX::drawFilledEllipse(int16_t x, int16_t y, uint16_t radiusX, uint16_t radiusY, uint8_t color) {
+    // Check if the ellipse is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x - radiusX > clipRect.right || x + radiusX < clipRect.left || y - radiusY > clipRect.bottom || y + radiusY < clipRect.top)
+        return;
+    bool clip = (x - radiusX < clipRect.left || x + radiusX > clipRect.right || y - radiusY < clipRect.top || y + radiusY > clipRect.bottom);
 
-    // Copy the bitmap to screen buffer
-    uint16_t uStart = x + uOffset;
-    int r1 = DIRTY_RECT_X(x);
-    int r2 = DIRTY_RECT_X(xEnd);
-    for(uint16_t v = y + vOffset; y <= yEnd; y++, v++) {
-        uint16_t u = uStart;
-        for(uint16_t xp = x; xp <= xEnd; xp++, u++) {
-            int bitmapOffset = bitmapWidth * v + u;
-            if(bitmap[bitmapOffset] != transparentColor) {
-                if(SCREENBUFFER_SECTOR(y)) {
-                    int ysb = y - 256;
-                    int screenBufferOffset = 320 * ysb + xp;
-                    screenBuffer[1][screenBufferOffset] = bitmap[bitmapOffset];
-                } else {
-                    int screenBufferOffset = 320 * y + xp;
-                    screenBuffer[0][screenBufferOffset] = bitmap[bitmapOffset];
-                }
-            }
-        }
-        for(int i = r1; i <= r2; i++)
-            dirtyRects[y][i] = true;
+    EllipseRows rows;
+    setupEllipseRows(&rows, radiusX, radiusY);
+    for(int16_t d = 0; d <= radiusY; d++) {
+        int16_t w = nextEllipseRow(&rows);
+        fillRowPair(y - d, y + d, x - w, x + w, color, clip);
     }
 }
 
-void GFX::scaleAndRotateBitmap(uint8_t* destination, uint16_t* destinationWidth, uint16_t* destinationHeight,
-            uint8_t* source, uint16_t sourceWidth, uint16_t sourceHeight, float scaleX, float scaleY, float rotation, uint_fast16_t backgroundColor) {
-    float sinTheta = fastSin(rotation);
-    float cosTheta = fastCos(rotation);
+void GFX::drawRoundedRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint8_t color) {
+    // Check if the rectangle is outside the clipping rectangle
+    if(width == 0 || height == 0)
+        return;
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right || y > clipRect.bottom || x + width - 1 < clipRect.left || y + height - 1 < clipRect.top)
+        return;
+    bool clip = (x < clipRect.left || x + width - 1 > clipRect.right || y < clipRect.top || y + height - 1 > clipRect.bottom);
+
+    // The corners are quarters of an ellipse with both radii equal to radius,
+    // centered on the corners of the inner rectangle (left, top) - (right, bottom)
+    if(radius > (width - 1) / 2)
+        radius = (width - 1) / 2;
+    if(radius > (height - 1) / 2)
+        radius = (height - 1) / 2;
+    int16_t left = x + radius;
+    int16_t right = x + width - 1 - radius;
+    int16_t top = y + radius;
+    int16_t bottom = y + height - 1 - radius;
+
+    EllipseRows rows;
+    setupEllipseRows(&rows, radius, radius);
+    int16_t outer = nextEllipseRow(&rows);
+    for(int16_t d = 0; d <= radius; d++) {
+        int16_t next = (d < radius) ? nextEllipseRow(&rows) : -1;
+        int16_t inner = (next + 1 < outer) ? next + 1 : outer;
+        outlineRow(top - d, left, right, inner, outer, color, clip);
+        if(bottom != top || d != 0)
+            outlineRow(bottom + d, left, right, inner, outer, color, clip);
+        outer = next;
+    }
 
+    // Vertical sides
+    if(bottom - top > 1) {
+        drawClippedColumn(x, top + 1, bottom - 1, color);
+        drawClippedColumn(x + width - 1, top + 1, bottom - 1, color);
+    }
+}
+
+void GFX::drawFilledRoundedRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t radius, uint8_t color) {
+    // Check if the rectangle is outside the clipping rectangle
+    if(width == 0 || height == 0)
+        return;
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right || y > clipRect.bottom || x + width - 1 < clipRect.left || y + height - 1 < clipRect.top)
+        return;
+    bool clip = (x < clipRect.left || x + width - 1 > clipRect.right || y < clipRect.top || y + height - 1 > clipRect.bottom);
+
+    if(radius > (width - 1) / 2)
+        radius = (width - 1) / 2;
+    if(radius > (height - 1) / 2)
+        radius = (height - 1) / 2;
+    int16_t left = x + radius;
+    int16_t right = x + width - 1 - radius;
+    int16_t top = y + radius;
+    int16_t bottom = y + height - 1 - radius;
+
+    // Rounded rows
+    EllipseRows rows;
+    setupEllipseRows(&rows, radius, radius);
+    for(int16_t d = 0; d <= radius; d++) {
+        int16_t w = nextEllipseRow(&rows);
+        fillRowPair(top - d, bottom + d, left - w, right + w, color, clip);
+    }
+
+    // Rows between the corners, clipped once
+    int16_t x1 = x;
+    int16_t x2 = x + width - 1;
+    int16_t y1 = top + 1;
+    int16_t y2 = bottom - 1;
+    if(clip) {
+        if(x1 < clipRect.left) x1 = clipRect.left;
+        if(x2 > clipRect.right) x2 = clipRect.right;
+        if(y1 < clipRect.top) y1 = clipRect.top;
+        if(y2 > clipRect.bottom) y2 = clipRect.bottom;
+    }
+    for(int16_t row = y1; row <= y2; row++)
+        drawSpan(row, x1, x2, color);
+}
+
+// Angular range of an arc, as the directions of its ends in Q15. A point is
+// tested with cross and dot products, so no angle is computed per pixel.
+struct ArcRange {
+    int32_t startX;
+    int32_t startY;
+    int32_t endX;
+    int32_t endY;
+    bool full;      // The arc is a whole circle
+    bool wide;      // The arc is longer than half a circle
+};
+
+static void setupArcRange(ArcRange* arc, float startAngle, float endAngle) {
+    float sweep = fmodf(endAngle - startAngle, 360);
+    if(sweep < 0)
+        sweep += 360;
+    arc->full = (endAngle - startAngle >= 360 || startAngle - endAngle >= 360);
+    arc->wide = (sweep > 180);
+    int32_t start = degreesToAngle(startAngle);
+    int32_t end = degreesToAngle(endAngle);
+    arc->startX = cosQ15(start);
+    arc->startY = sinQ15(start);
+    arc->endX = cosQ15(end);
+    arc->endY = sinQ15(end);
+}
+
+static bool isInArc(ArcRange* arc, int32_t u, int32_t v) {
+    // cross(a, b) > 0 when b is clockwise from a (y grows downwards)
+    if(arc->full)
+        return true;
+    int64_t startCross = (int64_t)arc->startX * v - (int64_t)arc->startY * u;
+    int64_t endCross = (int64_t)u * arc->endY - (int64_t)v * arc->endX;
+    if(arc->wide)
+        return !(startCross < 0 && endCross < 0);
+    int64_t dot = (int64_t)(arc->startX + arc->endX) * u + (int64_t)(arc->startY + arc->endY) * v;
+    return startCross >= 0 && endCross >= 0 && dot >= 0;
+}
+
+void GFX::arcRow(int16_t x, int16_t y, int16_t v, int16_t inner, int16_t outer, ArcRange* arc, uint8_t color) {
+    // Draw the pixels of a circle row, like outlineRow, that are inside the arc
+    if(y < clipRect.top || y > clipRect.bottom)
+        return;
+    uint8_t* line = lineAddress(y);
+    int16_t clipLeft = clipRect.left;
+    int16_t clipRight = clipRect.right;
+
+    // Plotted pixels on each side of the center: (-1, 0) => none
+    int16_t leftFirst = -1;
+    int16_t leftLast = 0;
+    int16_t rightFirst = -1;
+    int16_t rightLast = 0;
+    for(int16_t u = inner; u <= outer; u++) {
+        if(x - u >= clipLeft && x - u <= clipRight && isInArc(arc, -u, v)) {
+            line[x - u] = color;
+            if(leftFirst < 0)
+                leftFirst = u;
+            leftLast = u;
+        }
+        if(u != 0 && x + u >= clipLeft && x + u <= clipRight && isInArc(arc, u, v)) {
+            line[x + u] = color;
+            if(rightFirst < 0)
+                rightFirst = u;
+            rightLast = u;
+        }
+    }
+
+    // Set dirty rectangles once per side
+    if(leftFirst >= 0) {
+        for(int i = DIRTY_RECT_X(x - leftLast); i <= DIRTY_RECT_X(x - leftFirst); i++)
+            dirtyRects[y][i] = true;
+    }
+    if(rightFirst >= 0) {
+        for(int i = DIRTY_RECT_X(x + rightFirst); i <= DIRTY_RECT_X(x + rightLast); i++)
+            dirtyRects[y][i] = true;
+    }
+}
+
+void GFX::drawArc(int16_t x, int16_t y, uint16_t radius, float startAngle, float endAngle, uint8_t color) {
+    // Draw the part of the circle drawn by drawCircle going clockwise from
+    // startAngle to endAngle. Angles are in degrees, 0 points to the right.
+    // Check if the circle is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x - radius > clipRect.right || x + radius < clipRect.left || y - radius > clipRect.bottom || y + radius < clipRect.top)
+        return;
+    ArcRange arc;
+    setupArcRange(&arc, startAngle, endAngle);
+
+    uint8_t* table = getCircleTable(radius);
+    if(table != NULL) {
+        // Same rows of drawCircle, keeping only the pixels inside the arc
+        for(int16_t d = 0; d <= radius; d++) {
+            int16_t outer = table[d];
+            int16_t inner = (d < radius) ? table[d + 1] + 1 : 0;
+            if(inner > outer)
+                inner = outer;
+            arcRow(x, y - d, -d, inner, outer, &arc, color);
+            if(d != 0)
+                arcRow(x, y + d, d, inner, outer, &arc, color);
+        }
+        return;
+    }
+
+    // Radius too big for the tables: use the midpoint algorithm
+    int16_t px = radius;
+    int16_t py = 0;
+    int16_t dx = 1 - 2 * radius;
+    int16_t dy = 1;
+    int16_t err = 0;
+
+    while(px >= py) {
+        const int u[8] = { px, py, -py, -px, -px, -py, py, px };
+        const int v[8] = { py, px, px, py, -py, -px, -px, -py };
+        for(int i = 0; i < 8; i++)
+            if(isInArc(&arc, u[i], v[i]))
+                drawClippedPixel(x + u[i], y + v[i], color);
+
+        py++;
+        err += dy;
+        dy += 2;
+        if(2 * err + dx > 0) {
+            px--;
+            err += dx;
+            dx += 2;
+        }
+    }
+}
+
+void GFX::drawBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t flip) {
+    // Check if bitmap is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right) return;
+    if(y > clipRect.bottom) return;
+    if(x + width - 1 < clipRect.left) return;
+    if(y + height - 1 < clipRect.top) return;
+
+    // Offset to get the bitmap pixels
+    int16_t uOffset = -x;
+    int16_t vOffset = -y;
+
+    // Calculate the visible part of the bitmap
+    uint16_t bitmapWidth = width;
+    uint16_t bitmapHeight = height;
+    cropToView(&x, &width, clipRect.left, clipRect.right);
+    int16_t yEnd = cropToView(&y, &height, clipRect.top, clipRect.bottom);
+
+    // First source pixel and source strides. A flipped bitmap is read
+    // backwards, so no temporary copy is needed.
+    int u = x + uOffset;
+    int v = y + vOffset;
+    int uStep = 1;
+    int vStep = bitmapWidth;
+    if(flip & FLIP_HORIZONTAL) {
+        u = bitmapWidth - 1 - u;
+        uStep = -1;
+    }
+    if(flip & FLIP_VERTICAL) {
+        v = bitmapHeight - 1 - v;
+        vStep = -vStep;
+    }
+    uint8_t* source = bitmap + bitmapWidth * v + u;
+
+    // Copy the bitmap to screen buffer line by line
+    int r1 = DIRTY_RECT_X(x);
+    int r2 = DIRTY_RECT_X(x + width - 1);
+    for( ; y <= yEnd ; y++, source += vStep) {
+        uint8_t* destination = lineAddress(y) + x;
+        if(uStep > 0) {
+            memcpy(destination, source, width);
+        } else {
+            uint8_t* s = source;
+            for(uint8_t* end = destination + width; destination < end; destination++, s--)
+                *destination = *s;
+        }
+        for(int i = r1; i <= r2; i++)
+            dirtyRects[y][i] = true;
+    }
+}
+
+void GFX::drawTransparentBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor, uint8_t flip) {
+    // Check if bitmap is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right) return;
+    if(y > clipRect.bottom) return;
+    if(x + width - 1 < clipRect.left) return;
+    if(y + height - 1 < clipRect.top) return;
+
+    // Offset to get the bitmap pixels
+    int16_t uOffset = -x;
+    int16_t vOffset = -y;
+
+    // Calculate the visible part of the bitmap
+    uint16_t bitmapWidth = width;
+    uint16_t bitmapHeight = height;
+    int16_t xEnd = cropToView(&x, &width, clipRect.left, clipRect.right);
+    int16_t yEnd = cropToView(&y, &height, clipRect.top, clipRect.bottom);
+
+    // First source pixel and source strides (see drawBitmap)
+    int u = x + uOffset;
+    int v = y + vOffset;
+    int uStep = 1;
+    int vStep = bitmapWidth;
+    if(flip & FLIP_HORIZONTAL) {
+        u = bitmapWidth - 1 - u;
+        uStep = -1;
+    }
+    if(flip & FLIP_VERTICAL) {
+        v = bitmapHeight - 1 - v;
+        vStep = -vStep;
+    }
+    uint8_t* source = bitmap + bitmapWidth * v + u;
+
+    // Copy the bitmap to screen buffer
+    int r1 = DIRTY_RECT_X(x);
+    int r2 = DIRTY_RECT_X(xEnd);
+    for( ; y <= yEnd; y++, source += vStep) {
+        uint8_t* destination = lineAddress(y) + x;
+        uint8_t* s = source;
+        for(uint8_t* end = destination + width; destination < end; destination++, s += uStep) {
+            if(*s != transparentColor)
+                *destination = *s;
+        }
+        for(int i = r1; i <= r2; i++)
+            dirtyRects[y][i] = true;
+    }
+}
+
+void GFX::drawTransparentBitmapSaveUnder(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor,
+            uint8_t* saveBuffer, uint8_t flip) {
+    // Like drawTransparentBitmap, but the covered pixels are first saved in
+    // saveBuffer (width x height bytes), so that restoreSaveUnder can erase
+    // the bitmap. Only the visible part of the buffer is written. Each row is
+    // saved and composited while it is in cache, with a single clipping.
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right) return;
+    if(y > clipRect.bottom) return;
+    if(x + width - 1 < clipRect.left) return;
+    if(y + height - 1 < clipRect.top) return;
+
+    // Offset to get the bitmap pixels
+    int16_t uOffset = -x;
+    int16_t vOffset = -y;
+
+    // Calculate the visible part of the bitmap
+    uint16_t bitmapWidth = width;
+    uint16_t bitmapHeight = height;
+    int16_t xEnd = cropToView(&x, &width, clipRect.left, clipRect.right);
+    int16_t yEnd = cropToView(&y, &height, clipRect.top, clipRect.bottom);
+
+    // The save buffer is never flipped
+    uint8_t* saved = saveBuffer + bitmapWidth * (y + vOffset) + x + uOffset;
+
+    // First source pixel and source strides (see drawBitmap)
+    int u = x + uOffset;
+    int v = y + vOffset;
+    int uStep = 1;
+    int vStep = bitmapWidth;
+    if(flip & FLIP_HORIZONTAL) {
+        u = bitmapWidth - 1 - u;
+        uStep = -1;
+    }
+    if(flip & FLIP_VERTICAL) {
+        v = bitmapHeight - 1 - v;
+        vStep = -vStep;
+    }
+    uint8_t* source = bitmap + bitmapWidth * v + u;
+
+    int r1 = DIRTY_RECT_X(x);
+    int r2 = DIRTY_RECT_X(xEnd);
+    uint8_t (*dirty)[5] = dirtyRects;
+    for( ; y <= yEnd; y++, source += vStep, saved += bitmapWidth) {
+        uint8_t* destination = lineAddress(y) + x;
+        memcpy(saved, destination, width);
+        uint8_t* s = source;
+        for(uint8_t* end = destination + width; destination < end; destination++, s += uStep) {
+            if(*s != transparentColor)
+                *destination = *s;
+        }
+        for(int i = r1; i <= r2; i++)
+            dirty[y][i] = true;
+    }
+}
+
+void GFX::restoreSaveUnder(uint8_t* saveBuffer, int16_t x, int16_t y, uint16_t width, uint16_t height) {
+    // Put back the pixels saved by drawTransparentBitmapSaveUnder. The
+    // clipping rectangle and origin must be the same as when they were saved,
+    // so that exactly the saved part of the buffer is drawn. Restore
+    // overlapping bitmaps in reverse drawing order.
+    drawBitmap(saveBuffer, x, y, width, height);
+}
+
+void GFX::drawRemappedBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t* remap, uint8_t flip) {
+    drawRemappedRows(bitmap, x, y, width, height, false, 0, remap, flip);
+}
+
+void GFX::drawTransparentRemappedBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor,
+            const uint8_t* remap, uint8_t flip) {
+    drawRemappedRows(bitmap, x, y, width, height, true, transparentColor, remap, flip);
+}
+
+void GFX::drawRemappedRows(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, bool transparent, uint8_t transparentColor,
+            const uint8_t* remap, uint8_t flip) {
+    // Draw a bitmap translating every color through the remap table, for
+    // flashes, tints and team colors without extra copies of the bitmap. The
+    // table needs an entry for every color used by the bitmap, so 16 entries
+    // are enough for 16 color bitmaps. The transparent color is checked
+    // before remapping.
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right) return;
+    if(y > clipRect.bottom) return;
+    if(x + width - 1 < clipRect.left) return;
+    if(y + height - 1 < clipRect.top) return;
+
+    // Offset to get the bitmap pixels
+    int16_t uOffset = -x;
+    int16_t vOffset = -y;
+
+    // Calculate the visible part of the bitmap
+    uint16_t bitmapWidth = width;
+    uint16_t bitmapHeight = height;
+    int16_t xEnd = cropToView(&x, &width, clipRect.left, clipRect.right);
+    int16_t yEnd = cropToView(&y, &height, clipRect.top, clipRect.bottom);
+
+    // First source pixel and source strides (see drawBitmap)
+    int u = x + uOffset;
+    int v = y + vOffset;
+    int uStep = 1;
+    int vStep = bitmapWidth;
+    if(flip & FLIP_HORIZONTAL) {
+        u = bitmapWidth - 1 - u;
+        uStep = -1;
+    }
+    if(flip & FLIP_VERTICAL) {
+        v = bitmapHeight - 1 - v;
+        vStep = -vStep;
+    }
+    uint8_t* source = bitmap + bitmapWidth * v + u;
+
+    int r1 = DIRTY_RECT_X(x);
+    int r2 = DIRTY_RECT_X(xEnd);
+    uint8_t (*dirty)[5] = dirtyRects;
+    for( ; y <= yEnd; y++, source += vStep) {
+        uint8_t* destination = lineAddress(y) + x;
+        uint8_t* s = source;
+        uint8_t* end = destination + width;
+        if(!transparent) {
+            for( ; destination < end; destination++, s += uStep)
+                *destination = remap[*s];
+        } else {
+            for( ; destination < end; destination++, s += uStep) {
+                if(*s != transparentColor)
+                    *destination = remap[*s];
+            }
+        }
+        for(int i = r1; i <= r2; i++)
+            dirty[y][i] = true;
+    }
+}
+
+// Fixed point (16.16) mapping from destination pixels to source pixels
+struct AffineMapping {
+    int32_t x, y;       // Source coordinates of the top-left destination pixel
+    int32_t duX, duY;   // Increments for one step along a destination row
+    int32_t dvX, dvY;   // Increments for one step along a destination column
+};
+
+static void setupAffineMapping(AffineMapping* m, uint16_t sourceWidth, uint16_t sourceHeight,
+            uint16_t destinationWidth, uint16_t destinationHeight, float scaleX, float scaleY, float rotation) {
+    float sinTheta = interpolatedSin(rotation);
+    float cosTheta = interpolatedCos(rotation);
+    float sourceCenterX = 0.5 * (sourceWidth - 1);
+    float sourceCenterY = 0.5 * (sourceHeight - 1);
+    float destinationCenterX = 0.5 * (destinationWidth - 1);
+    float destinationCenterY = 0.5 * (destinationHeight - 1);
+
+    m->duX = lroundf(cosTheta / scaleX * 65536);
+    m->duY = lroundf(-sinTheta / scaleY * 65536);
+    m->dvX = lroundf(sinTheta / scaleX * 65536);
+    m->dvY = lroundf(cosTheta / scaleY * 65536);
+    m->x = lroundf((sourceCenterX - (cosTheta * destinationCenterX + sinTheta * destinationCenterY) / scaleX) * 65536);
+    m->y = lroundf((sourceCenterY - (cosTheta * destinationCenterY - sinTheta * destinationCenterX) / scaleY) * 65536);
+}
+
+// Restrict [*iStart, *iEnd] to the values of i for which lo < p + i * d < hi.
+// Returns false if no value of i satisfies the condition.
+static bool clipAffineSpan(int32_t p, int32_t d, int32_t lo, int32_t hi, int* iStart, int* iEnd) {
+    int first, last;
+    if(d > 0) {
+        first = floorDiv(lo - p, d) + 1;
+        last = -floorDiv(p - hi, d) - 1;
+    } else if(d < 0) {
+        first = floorDiv(p - hi, -d) + 1;
+        last = -floorDiv(lo - p, -d) - 1;
+    } else {
+        if(p <= lo || p >= hi)
+            return false;
+        return *iStart <= *iEnd;
+    }
+    *iStart = max(*iStart, first);
+    *iEnd = min(*iEnd, last);
+    return *iStart <= *iEnd;
+}
+
+// Find the part [*iStart, *iEnd] of a destination row that maps inside the source
+// bitmap. Source coordinates are truncated, so values in (-1, 0) still map to
+// the first source row or column.
+static bool clipAffineRow(int32_t x, int32_t y, AffineMapping* m, uint16_t sourceWidth, uint16_t sourceHeight, int* iStart, int* iEnd) {
+    if(!clipAffineSpan(x, m->duX, -65536, (int32_t)sourceWidth << 16, iStart, iEnd))
+        return false;
+    return clipAffineSpan(y, m->duY, -65536, (int32_t)sourceHeight << 16, iStart, iEnd);
+}
+
+void GFX::scaleAndRotateBitmap(uint8_t* destination, uint16_t* destinationWidth, uint16_t* destinationHeight,
+            uint8_t* source, uint16_t sourceWidth, uint16_t sourceHeight, float scaleX, float scaleY, float rotation, uint_fast16_t backgroundColor) {
     // Calculate width and height of resulting bitmap
+    getScaledAndRotatedSize(destinationWidth, destinationHeight, sourceWidth, sourceHeight, scaleX, scaleY, rotation);
+
+    // Map every pixel of destination bitmap in source bitmap
+    AffineMapping m;
+    setupAffineMapping(&m, sourceWidth, sourceHeight, *destinationWidth, *destinationHeight, scaleX, scaleY, rotation);
+
+    int32_t rowX = m.x;
+    int32_t rowY = m.y;
+    for(int v = 0; v < *destinationHeight; v++, rowX += m.dvX, rowY += m.dvY) {
+        int iStart = 0;
+        int iEnd = *destinationWidth - 1;
+        if(!clipAffineRow(rowX, rowY, &m, sourceWidth, sourceHeight, &iStart, &iEnd)) {
+            memset(destination, backgroundColor, *destinationWidth);
+            destination += *destinationWidth;
+            continue;
+        }
+
+        // Background on the left of the span
+        memset(destination, backgroundColor, iStart);
+        destination += iStart;
+
+        // Sample the span. The source row pointer is stepped instead of
+        // being recalculated, so there are no multiplications per pixel.
+        int32_t sx = rowX + iStart * m.duX;
+        int32_t sy = rowY + iStart * m.duY;
+        int sv = (sy > 0) ? (sy >> 16) : 0;
+        uint8_t* sourceRow = source + sourceWidth * sv;
+        for(uint8_t* end = destination + (iEnd - iStart + 1); destination < end; destination++, sx += m.duX, sy += m.duY) {
+            int nextSv = (sy > 0) ? (sy >> 16) : 0;
+            for( ; sv < nextSv; sv++)
+                sourceRow += sourceWidth;
+            for( ; sv > nextSv; sv--)
+                sourceRow -= sourceWidth;
+            *destination = sourceRow[(sx > 0) ? (sx >> 16) : 0];
+        }
+
+        // Background on the right of the span
+        int right = *destinationWidth - 1 - iEnd;
+        memset(destination, backgroundColor, right);
+        destination += right;
+    }
+}
+
+void GFX::getScaledAndRotatedSize(uint16_t* destinationWidth, uint16_t* destinationHeight,
+            uint16_t sourceWidth, uint16_t sourceHeight, float scaleX, float scaleY, float rotation) {
+    float sinTheta = interpolatedSin(rotation);
+    float cosTheta = interpolatedCos(rotation);
+
     int w1 = scaleX * sourceWidth * cosTheta + scaleY * sourceHeight * sinTheta;
     int w2 = scaleX * sourceWidth * cosTheta - scaleY * sourceHeight * sinTheta;
     *destinationWidth = max(abs(w1), abs(w2));
     int h1 = scaleX * sourceWidth * sinTheta + scaleY * sourceHeight * cosTheta;
     int h2 = scaleX * sourceWidth * sinTheta - scaleY * sourceHeight * cosTheta;
     *destinationHeight = max(abs(h1), abs(h2));
+}
 
-    // Map every pixel of destination bitmap in source bitmap
-    float sourceCenterX = 0.5 * (sourceWidth - 1);
-    float sourceCenterY = 0.5 * (sourceHeight - 1);
-    float destinationCenterX = 0.5 * (*destinationWidth - 1);
-    float destinationCenterY = 0.5 * (*destinationHeight - 1);
-
-    for(float v = -destinationCenterY; v <= destinationCenterY; v = v + 1) {
-        for(float u = -destinationCenterX; u <= destinationCenterX; u = u + 1) {
-            int sx = sourceCenterX + (cosTheta * u + sinTheta * v) / scaleX;
-            int sy = sourceCenterY + (cosTheta * v - sinTheta * u) / scaleY;
-
-            int destinationOffset = *destinationWidth * (v + destinationCenterY) + u + destinationCenterX;
-            if(sx >= 0 && sx < sourceWidth && sy >= 0 && sy < sourceHeight) {
-                int sourceOffset = sourceWidth * sy + sx;
-                destination[destinationOffset] = source[sourceOffset];
-            } else {
-                destination[destinationOffset] = backgroundColor;
-            }
+void GFX::drawRotatedScaledBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height,
+            float scaleX, float scaleY, float rotation, uint8_t transparentColor) {
+    // Draws the same pixels as scaleAndRotateBitmap followed by drawTransparentBitmap
+    // at (x, y), but samples the source directly into the screen buffer.
+    uint16_t destinationWidth, destinationHeight;
+    getScaledAndRotatedSize(&destinationWidth, &destinationHeight, width, height, scaleX, scaleY, rotation);
+
+    // Check if the bounding box is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right) return;
+    if(y > clipRect.bottom) return;
+    if(x + destinationWidth - 1 < clipRect.left) return;
+    if(y + destinationHeight - 1 < clipRect.top) return;
+
+    AffineMapping m;
+    setupAffineMapping(&m, width, height, destinationWidth, destinationHeight, scaleX, scaleY, rotation);
+
+    // Visible part of the bounding box
+    int16_t xStart = x;
+    uint16_t visibleWidth = destinationWidth;
+    int16_t xEnd = cropToView(&xStart, &visibleWidth, clipRect.left, clipRect.right);
+    int16_t yStart = y;
+    uint16_t visibleHeight = destinationHeight;
+    int16_t yEnd = cropToView(&yStart, &visibleHeight, clipRect.top, clipRect.bottom);
+    int32_t rowX = m.x + (yStart - y) * m.dvX;
+    int32_t rowY = m.y + (yStart - y) * m.dvY;
+
+    for(int16_t yp = yStart; yp <= yEnd; yp++, rowX += m.dvX, rowY += m.dvY) {
+        int iStart = xStart - x;
+        int iEnd = xEnd - x;
+        if(!clipAffineRow(rowX, rowY, &m, width, height, &iStart, &iEnd))
+            continue;
+
+        // Sample the span (see scaleAndRotateBitmap)
+        int32_t sx = rowX + iStart * m.duX;
+        int32_t sy = rowY + iStart * m.duY;
+        int sv = (sy > 0) ? (sy >> 16) : 0;
+        uint8_t* sourceRow = bitmap + width * sv;
+        uint8_t* destination = lineAddress(yp) + x + iStart;
+        for(uint8_t* end = destination + (iEnd - iStart + 1); destination < end; destination++, sx += m.duX, sy += m.duY) {
+            int nextSv = (sy > 0) ? (sy >> 16) : 0;
+            for( ; sv < nextSv; sv++)
+                sourceRow += width;
+            for( ; sv > nextSv; sv--)
+                sourceRow -= width;
+            uint8_t pixel = sourceRow[(sx > 0) ? (sx >> 16) : 0];
+            if(pixel != transparentColor)
+                *destination = pixel;
         }
+
+        int r1 = DIRTY_RECT_X(x + iStart);
+        int r2 = DIRTY_RECT_X(x + iEnd);
+        for(int i = r1; i <= r2; i++)
+            dirtyRects[yp][i] = true;
+    }
+}
+
+// Pixel masks for the 16 values of a nibble. The most significant bit is the
+// leftmost pixel, that is the lowest address (little endian).
+static const uint32_t nibbleMask[16] = {
+    0x00000000, 0xFF000000, 0x00FF0000, 0xFFFF0000, 0x0000FF00, 0xFF00FF00, 0x00FFFF00, 0xFFFFFF00,
+    0x000000FF, 0xFF0000FF, 0x00FF00FF, 0xFFFF00FF, 0x0000FFFF, 0xFF00FFFF, 0x00FFFFFF, 0xFFFFFFFF
+};
+
+static inline bool drawBitmapByte(uint8_t* p, uint8_t bits, uint8_t color, uint32_t color32, bool wordHigh, bool wordLow) {
+    // Draw the 8 pixels of a byte of a monochrome bitmap. Each nibble is
+    // written with a single masked word if the caller allows the access to
+    // all of its 4 pixels, else pixel by pixel. Returns true if any pixel
+    // was drawn.
+    if(bits == 0)
+        return false;
+    if(bits == 0xFF && wordHigh && wordLow) {
+        memset(p, color, 8);
+        return true;
+    }
+    uint32_t word, mask;
+    if(wordHigh) {
+        mask = nibbleMask[bits >> 4];
+        memcpy(&word, p, 4);
+        word = (word & ~mask) | (color32 & mask);
+        memcpy(p, &word, 4);
+    } else {
+        for(int i = 0; i < 4; i++)
+            if(bits & (0x80 >> i))
+                p[i] = color;
     }
+    if(wordLow) {
+        mask = nibbleMask[bits & 0x0F];
+        memcpy(&word, p + 4, 4);
+        word = (word & ~mask) | (color32 & mask);
+        memcpy(p + 4, &word, 4);
+    } else {
+        for(int i = 4; i < 8; i++)
+            if(bits & (0x80 >> i))
+                p[i] = color;
+    }
+    return true;
 }
 
 void GFX::drawMonochromeBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color) {
+    // Check if bitmap is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right) return;
+    if(y > clipRect.bottom) return;
+    if(x + width - 1 < clipRect.left) return;
+    if(y + height - 1 < clipRect.top) return;
+
+    // Calculate the visible part of the bitmap
     int widthBytes = (width + 7) >> 3;
+    int16_t xStart = x;
+    uint16_t visibleWidth = width;
+    int16_t xEnd = cropToView(&xStart, &visibleWidth, clipRect.left, clipRect.right);
+    int16_t yStart = y;
+    uint16_t visibleHeight = height;
+    int16_t yEnd = cropToView(&yStart, &visibleHeight, clipRect.top, clipRect.bottom);
+    int uStart = xStart - x;
+    int uEnd = xEnd - x;
+
+    // Every byte is expanded with the nibble masks. In the first and last
+    // byte the bits of the pixels outside the visible part are cleared, and
+    // a nibble is written as a word only if its 4 pixels are inside the
+    // clipping rectangle, so that nothing outside it is read or written.
+    // The bytes between them are always visible.
+    int firstByte = uStart >> 3;
+    int lastByte = uEnd >> 3;
+    uint8_t firstMask = 0xFF >> (uStart & 7);
+    uint8_t lastMask = 0xFF << (~uEnd & 7);
+    if(firstByte == lastByte)
+        firstMask &= lastMask;
+    int16_t firstX = x + (firstByte << 3);
+    int16_t lastX = x + (lastByte << 3);
+    bool firstHigh = firstX >= clipRect.left && firstX + 3 <= clipRect.right;
+    bool firstLow = firstX + 4 >= clipRect.left && firstX + 7 <= clipRect.right;
+    bool lastHigh = lastX >= clipRect.left && lastX + 3 <= clipRect.right;
+    bool lastLow = lastX + 4 >= clipRect.left && lastX + 7 <= clipRect.right;
+    uint32_t color32 = color * 0x01010101u;
+    int r1 = DIRTY_RECT_X(xStart);
+    int r2 = DIRTY_RECT_X(xEnd);
+
+    uint8_t* row = bitmap + widthBytes * (yStart - y);
+    for(int16_t yp = yStart; yp <= yEnd; yp++, row += widthBytes) {
+        uint8_t* line = lineAddress(yp) + x;
+        bool drawn = drawBitmapByte(line + (firstByte << 3), row[firstByte] & firstMask, color, color32, firstHigh, firstLow);
+        if(lastByte > firstByte) {
+            for(int b = firstByte + 1; b < lastByte; b++)
+                drawn |= drawBitmapByte(line + (b << 3), row[b], color, color32, true, true);
+            drawn |= drawBitmapByte(line + (lastByte << 3), row[lastByte] & lastMask, color, color32, lastHigh, lastLow);
+        }
+
+        // Set dirty rectangles once per row
+        if(drawn) {
+            for(int i = r1; i <= r2; i++)
+                dirtyRects[yp][i] = true;
+        }
+    }
+}
+
+// Expand a monochrome bitmap to twice its size with the Scale2x algorithm, like
+// drawMonochromeBitmap2x does, but into a monochrome destination bitmap
+static void scale2xMonochromeBitmap(uint8_t* destination, uint8_t* bitmap, uint16_t width, uint16_t height) {
+    int widthBytes = (width + 7) >> 3;
+    int destinationWidthBytes = (2 * width + 7) >> 3;
+    memset(destination, 0, destinationWidthBytes * 2 * height);
     for(int v=0; v<height; v++) {
+        uint8_t* line0 = destination + destinationWidthBytes * 2 * v;
+        uint8_t* line1 = line0 + destinationWidthBytes;
         for(int u=0; u<width; u++) {
-            if(ONSCREEN(x + u, y + v)) {
-                int b = u >> 3;     // the byte to select
-                int bit = ~u & 7;   // the bit to read
-                if(bitRead(bitmap[widthBytes * v + b], bit))
-                    drawPixel(x + u, y + v, color);
-            }
+            int b = u >> 3;
+            int bit = ~u & 7;
+            uint8_t valueE = bitRead(bitmap[widthBytes * v + b], bit);
+            uint8_t valueA = (v > 0) ? bitRead(bitmap[widthBytes * (v - 1) + b], bit) : 0;
+            uint8_t valueD = (v + 1 < height) ? bitRead(bitmap[widthBytes * (v + 1) + b], bit) : 0;
+            uint8_t valueC = (u > 0) ? bitRead(bitmap[widthBytes * v + ((u - 1) >> 3)], ~(u - 1) & 7) : 0;
+            uint8_t valueB = (u + 1 < width) ? bitRead(bitmap[widthBytes * v + ((u + 1) >> 3)], ~(u + 1) & 7) : 0;
+
+            uint8_t subpixel[4] = {valueE, valueE, valueE, valueE};
+            if(valueC == valueA && valueC != valueD && valueA != valueB)
+                subpixel[0] = valueA;
+            if(valueA == valueB && valueA != valueC && valueB != valueD)
+                subpixel[1] = valueB;
+            if(valueC == valueD && valueB != valueD && valueA != valueC)
+                subpixel[2] = valueC;
+            if(valueD == valueB && valueA != valueB && valueC != valueD)
+                subpixel[3] = valueD;
+
+            int u0 = 2 * u;
+            int u1 = u0 + 1;
+            line0[u0 >> 3] |= subpixel[0] << (~u0 & 7);
+            line0[u1 >> 3] |= subpixel[1] << (~u1 & 7);
+            line1[u0 >> 3] |= subpixel[2] << (~u0 & 7);
+            line1[u1 >> 3] |= subpixel[3] << (~u1 & 7);
         }
     }
 }
@@ -838,22 +2252,89 @@ void GFX::drawMonochromeBitmap2x(uint8_t* bitmap, int16_t x, int16_t y, uint16_t
             if(valueD == valueB && valueA != valueB && valueC != valueD)
                 subpixel[3] = valueD;
             
-            if(ONSCREEN(x + 2 * u, y + 2 * v) && subpixel[0])
+            if(subpixel[0])
                 drawPixel(x + 2 * u, y + 2 * v, color);
-            if(ONSCREEN(x + 2 * u + 1, y + 2 * v) && subpixel[1])
+            if(subpixel[1])
                 drawPixel(x + 2 * u + 1, y + 2 * v, color);
-            if(ONSCREEN(x + 2 * u, y + 2 * v + 1) && subpixel[2])
+            if(subpixel[2])
                 drawPixel(x + 2 * u, y + 2 * v + 1, color);
-            if(ONSCREEN(x + 2 * u + 1, y + 2 * v + 1) && subpixel[3])
+            if(subpixel[3])
                 drawPixel(x + 2 * u + 1, y + 2 * v + 1, color);
         }
     }
 }
 
+void GFX::drawMonochromeBitmapScaled(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color, uint8_t scale) {
+    // Check if bitmap is outside the clipping rectangle
+    x += clipRect.originX;
+    y += clipRect.originY;
+    if(x > clipRect.right) return;
+    if(y > clipRect.bottom) return;
+    if(x + width * scale - 1 < clipRect.left) return;
+    if(y + height * scale - 1 < clipRect.top) return;
+
+    // Every run of set pixels in a bitmap row becomes a span scale times wider,
+    // repeated on scale screen lines
+    int widthBytes = (width + 7) >> 3;
+    for(int v = 0; v < height; v++) {
+        // Screen lines covered by this bitmap row
+        int16_t yStart = y + v * scale;
+        uint16_t lines = scale;
+        if(yStart > clipRect.bottom)
+            break;
+        if(yStart + lines - 1 < clipRect.top)
+            continue;
+        int16_t yEnd = cropToView(&yStart, &lines, clipRect.top, clipRect.bottom);
+
+        uint8_t* row = bitmap + widthBytes * v;
+        int u = 0;
+        while(u < width) {
+            // Skip unset pixels, a whole byte at a time when possible
+            if((u & 7) == 0 && row[u >> 3] == 0) {
+                u += 8;
+                continue;
+            }
+            if(!bitRead(row[u >> 3], ~u & 7)) {
+                u++;
+                continue;
+            }
+
+            // Find the end of the run
+            int runStart = u;
+            while(u < width && bitRead(row[u >> 3], ~u & 7))
+                u++;
+
+            // Draw the scaled run
+            int16_t xStart = x + runStart * scale;
+            uint16_t spanWidth = (u - runStart) * scale;
+            if(xStart > clipRect.right)
+                break;
+            if(xStart + spanWidth - 1 < clipRect.left)
+                continue;
+            int16_t xEnd = cropToView(&xStart, &spanWidth, clipRect.left, clipRect.right);
+            int r1 = DIRTY_RECT_X(xStart);
+            int r2 = DIRTY_RECT_X(xEnd);
+            for(int16_t yp = yStart; yp <= yEnd; yp++) {
+                memset(lineAddress(yp) + xStart, color, spanWidth);
+                for(int i = r1; i <= r2; i++)
+                    dirtyRects[yp][i] = true;
+            }
+        }
+    }
+}
+
 void GFX::copyScreenBufferRect(uint8_t* buffer, int16_t x, int16_t y, uint16_t width, uint16_t height) {
-    // Check if rect is outside the screen
-    if(x >= 320) return;
-    if(y >= 480) return;
+    // Copy a rect of the target (the screen buffer or a surface). The rect is
+    // relative to the origin, but only clipped to the target: reading outside
+    // the clipping rectangle is harmless.
+    x += clipRect.originX;
+    y += clipRect.originY;
+    int16_t targetWidth = (target != NULL) ? target->width : 320;
+    int16_t targetHeight = (target != NULL) ? target->height : 480;
+
+    // Check if rect is outside the target
+    if(x >= targetWidth) return;
+    if(y >= targetHeight) return;
     if(x + width - 1 < 0) return;
     if(y + height - 1 < 0) return;
 
@@ -863,28 +2344,127 @@ void GFX::copyScreenBufferRect(uint8_t* buffer, int16_t x, int16_t y, uint16_t w
 
     // Calculate the visible part of the bitmap
     uint16_t rectWidth = width;
-    cropToViewSize(&x, &width, 320);
-    int16_t yEnd = cropToViewSize(&y, &height, 480);
+    cropToView(&x, &width, 0, targetWidth - 1);
+    int16_t yEnd = cropToView(&y, &height, 0, targetHeight - 1);
 
-    // Copy the screen buffer rect to the buffer line by line
+    // Copy the target rect to the buffer line by line
     uint16_t u = x + uOffset;
     uint16_t v = y + vOffset;
-    for( ; y <= yEnd ; y++, v++) {
-        int rectOffset = rectWidth * v + u;
-        if(SCREENBUFFER_SECTOR(y)) {
-            int ysb = y - 256;
-            int screenBufferOffset = 320 * ysb + x;
-            memcpy(buffer + rectOffset, screenBuffer[1] + screenBufferOffset, width);
-        } else {
-            int screenBufferOffset = 320 * y + x;
-            memcpy(buffer + rectOffset, screenBuffer[0] + screenBufferOffset, width);
-        }
+    for( ; y <= yEnd ; y++, v++)
+        memcpy(buffer + rectWidth * v + u, lineAddress(y) + x, width);
+}
+
+void GFX::copyRect(int16_t sourceX, int16_t sourceY, uint16_t width, uint16_t height, int16_t destinationX, int16_t destinationY) {
+    // Copy a rect of the target to another position of the target. The rects
+    // can overlap. Both are relative to the origin: the destination is clipped
+    // to the clipping rectangle, the source to the target. Only the
+    // destination is marked dirty.
+    int32_t dx = (int32_t)destinationX - sourceX;
+    int32_t dy = (int32_t)destinationY - sourceY;
+    int32_t left = (int32_t)destinationX + clipRect.originX;
+    int32_t top = (int32_t)destinationY + clipRect.originY;
+    int32_t right = left + width - 1;
+    int32_t bottom = top + height - 1;
+    int16_t targetWidth = (target != NULL) ? target->width : 320;
+    int16_t targetHeight = (target != NULL) ? target->height : 480;
+    if(left < clipRect.left) left = clipRect.left;
+    if(top < clipRect.top) top = clipRect.top;
+    if(right > clipRect.right) right = clipRect.right;
+    if(bottom > clipRect.bottom) bottom = clipRect.bottom;
+    if(left < dx) left = dx;
+    if(top < dy) top = dy;
+    if(right > targetWidth - 1 + dx) right = targetWidth - 1 + dx;
+    if(bottom > targetHeight - 1 + dy) bottom = targetHeight - 1 + dy;
+    if(left > right || top > bottom || (dx == 0 && dy == 0))
+        return;
+
+    // Moving down, the rows are copied from the bottom, so that every source
+    // row is read before it is overwritten. Rows in the same line can overlap
+    // too, so they are moved with memmove.
+    uint16_t count = right - left + 1;
+    int16_t y = (dy > 0) ? bottom : top;
+    int16_t yStep = (dy > 0) ? -1 : 1;
+    int r1 = DIRTY_RECT_X(left);
+    int r2 = DIRTY_RECT_X(right);
+    uint8_t (*dirty)[5] = dirtyRects;
+    for(int16_t rows = bottom - top + 1; rows > 0; rows--, y += yStep) {
+        memmove(lineAddress(y) + left, lineAddress(y - dy) + left - dx, count);
+        for(int i = r1; i <= r2; i++)
+            dirty[y][i] = true;
+    }
+}
+
+void GFX::scrollRegion(int16_t dx, int16_t dy, uint8_t fillColor) {
+    // Move the content of the clipping rectangle by dx, dy and fill the part
+    // left uncovered with fillColor
+    int16_t left = clipRect.left;
+    int16_t top = clipRect.top;
+    int16_t right = clipRect.right;
+    int16_t bottom = clipRect.bottom;
+    if(left > right)
+        return;
+    int16_t x = left - clipRect.originX;
+    int16_t y = top - clipRect.originY;
+    copyRect(x, y, right - left + 1, bottom - top + 1, x + dx, y + dy);
+
+    for(int16_t row = top; row <= bottom; row++) {
+        int32_t sourceRow = (int32_t)row - dy;
+        if(sourceRow < top || sourceRow > bottom || dx <= left - right - 1 || dx >= right - left + 1)
+            drawSpan(row, left, right, fillColor);
+        else if(dx > 0)
+            drawSpan(row, left, left + dx - 1, fillColor);
+        else if(dx < 0)
+            drawSpan(row, right + dx + 1, right, fillColor);
     }
 }
 
 void GFX::setFont(Font* f) {
     font = f;
     fontSize = ((font->width + 7) >> 3) * font->height;
+
+    // Scaled glyphs of the previous font are no longer valid
+    clearGlyphCache();
+}
+
+Font* GFX::getFont() {
+    return font;
+}
+
+uint16_t GFX::getStringWidth(const char* string, uint8_t scale) {
+    // Width of the widest line, measured the same way drawString moves the cursor
+    int16_t cx = 0, width = 0;
+    uint8_t c;
+    int i = 0;
+    while((c = *(string + i)) != 0) {
+        if(c == 0x08)
+            cx -= font->width;
+        else if(c == 0x0A)
+            cx = 0;
+        else
+            cx += font->width;
+        if(cx > width)
+            width = cx;
+        i++;
+    }
+    return width * scale;
+}
+
+uint16_t GFX::getStringHeight(const char* string, uint8_t scale) {
+    uint16_t lines = 1;
+    int i = 0;
+    while(*(string + i) != 0) {
+        if(*(string + i) == 0x0A)
+            lines++;
+        i++;
+    }
+    return lines * font->height * scale;
+}
+
+void GFX::clearGlyphCache() {
+    for(int i = 0; i < 256; i++) {
+        free(glyphCache2x[i]);
+        glyphCache2x[i] = NULL;
+    }
 }
 
 void GFX::drawChar(int16_t x, int16_t y, char character, uint8_t color) {
@@ -893,8 +2473,24 @@ void GFX::drawChar(int16_t x, int16_t y, char character, uint8_t color) {
 }
 
 void GFX::drawChar2x(int16_t x, int16_t y, char character, uint8_t color) {
-    uint8_t* charBitmap = font->data + fontSize * character;
-    drawMonochromeBitmap2x(charBitmap, x, y, font->width, font->height, color);
+    // Scale the glyph the first time it is used, then draw it as a normal
+    // monochrome bitmap. Each glyph takes ((2 * width + 7) / 8) * 2 * height bytes.
+    uint8_t index = character;
+    if(glyphCache2x[index] == NULL) {
+        uint8_t* scaledGlyph = (uint8_t*)malloc(((2 * font->width + 7) >> 3) * 2 * font->height);
+        if(scaledGlyph == NULL) {
+            drawMonochromeBitmap2x(font->data + fontSize * index, x, y, font->width, font->height, color);
+            return;
+        }
+        scale2xMonochromeBitmap(scaledGlyph, font->data + fontSize * index, font->width, font->height);
+        glyphCache2x[index] = scaledGlyph;
+    }
+    drawMonochromeBitmap(glyphCache2x[index], x, y, 2 * font->width, 2 * font->height, color);
+}
+
+void GFX::drawCharScaled(int16_t x, int16_t y, char character, uint8_t color, uint8_t scale) {
+    uint8_t* charBitmap = font->data + fontSize * (uint8_t)character;
+    drawMonochromeBitmapScaled(charBitmap, x, y, font->width, font->height, color, scale);
 }
 
 void GFX::drawString(int16_t x, int16_t y, const char* string, uint8_t color) {
@@ -941,6 +2537,190 @@ void GFX::drawString2x(int16_t x, int16_t y, const char* string, uint8_t color)
     }
 }
 
+void GFX::drawStringScaled(int16_t x, int16_t y, const char* string, uint8_t color, uint8_t scale) {
+    int16_t cx = 0, cy = 0; // Relative cursor position
+    uint8_t c;
+    int i = 0;
+    while((c = *(string + i)) != 0) {
+        if(c == 0x08) {
+            // Backspace
+            cx -= scale * font->width;
+        } else if(c == 0x0A) {
+            // New line
+            cx = 0;
+            cy += scale * font->height;
+        } else {
+            // Draw character
+            drawCharScaled(x + cx, y + cy, c, color, scale);
+            cx += scale * font->width;
+        }
+        // Next character
+        i++;
+    }
+}
+
+void GFX::setProportionalFont(ProportionalFont* f) {
+    proportionalFont = f;
+}
+
+int16_t GFX::drawProportionalChar(int16_t x, int16_t y, char character, uint8_t color) {
+    // Draw the cropped glyph and return the cursor advance.
+    // Characters missing from the font are skipped.
+    uint8_t c = character;
+    if(c < proportionalFont->first || c > proportionalFont->last)
+        return 0;
+    ProportionalGlyph* glyph = &proportionalFont->glyphs[c - proportionalFont->first];
+    if(glyph->width > 0)
+        drawMonochromeBitmap(proportionalFont->data + glyph->offset, x + glyph->xOffset, y + glyph->yOffset, glyph->width, glyph->height, color);
+    return glyph->xAdvance;
+}
+
+void GFX::drawProportionalString(int16_t x, int16_t y, const char* string, uint8_t color) {
+    int16_t cx = 0, cy = 0; // Relative cursor position
+    uint8_t c;
+    uint8_t previous = 0;
+    int i = 0;
+    while((c = *(string + i)) != 0) {
+        if(c == 0x0A) {
+            // New line
+            cx = 0;
+            cy += proportionalFont->height;
+            previous = 0;
+        } else {
+            // Draw character
+            if(previous != 0)
+                cx += getKerning(previous, c);
+            cx += drawProportionalChar(x + cx, y + cy, c, color);
+            previous = c;
+        }
+        // Next character
+        i++;
+    }
+}
+
+int8_t GFX::getKerning(char left, char right) {
+    // Binary search of the pair in the kerning table
+    uint16_t key = ((uint8_t)left << 8) | (uint8_t)right;
+    int low = 0;
+    int high = proportionalFont->kerningCount - 1;
+    while(low <= high) {
+        int middle = (low + high) >> 1;
+        KerningPair* pair = &proportionalFont->kerning[middle];
+        uint16_t pairKey = (pair->left << 8) | pair->right;
+        if(pairKey == key)
+            return pair->adjust;
+        if(pairKey < key)
+            low = middle + 1;
+        else
+            high = middle - 1;
+    }
+    return 0;
+}
+
+bool GFX::initTextLabel(TextLabel* label, int16_t x, int16_t y, uint8_t color, uint8_t backgroundColor) {
+    // The label uses the current font. Returns false if there is no label or
+    // no font.
+    if(label == NULL)
+        return false;
+    label->x = x;
+    label->y = y;
+    label->color = color;
+    label->backgroundColor = backgroundColor;
+    label->font = font;
+    memset(label->text, 0, sizeof(label->text));
+    return font != NULL;
+}
+
+void GFX::drawTextLabel(TextLabel* label, int16_t x, int16_t y, const char* text, uint8_t color) {
+    if(label == NULL || label->font == NULL || text == NULL)
+        return;
+
+    // A label that moved is erased and drawn again at the new position
+    if(x != label->x || y != label->y) {
+        eraseTextLabel(label);
+        label->x = x;
+        label->y = y;
+    }
+
+    // Every cell is checked, not only the changed ones, so that glyphs that
+    // something else drew over are drawn again on the new background
+    bool textEnded = false;
+    for(int cell = 0; cell < TEXT_LABEL_LENGTH; cell++) {
+        char newChar = textEnded ? 0 : text[cell];
+        textEnded = (newChar == 0);
+        char oldChar = label->text[cell];
+        if(newChar == 0 && oldChar == 0)
+            break;
+        updateLabelCell(label, cell, oldChar, newChar, color);
+        label->text[cell] = newChar;
+    }
+    label->color = color;
+}
+
+void GFX::eraseTextLabel(TextLabel* label) {
+    // Give the background color back to the glyph pixels still on screen
+    if(label == NULL || label->font == NULL)
+        return;
+    for(int cell = 0; cell < TEXT_LABEL_LENGTH && label->text[cell] != 0; cell++)
+        updateLabelCell(label, cell, label->text[cell], 0, label->color);
+    memset(label->text, 0, sizeof(label->text));
+}
+
+void GFX::updateLabelCell(TextLabel* label, int cell, char oldChar, char newChar, uint8_t color) {
+    // Replace the glyph of oldChar with the one of newChar (0 => no glyph).
+    // A pixel of the old glyph that still has the label color is the label's
+    // own; any other pixel was drawn over and belongs to the scene now.
+    // Pixels of the new glyph are drawn transparently, the label's own pixels
+    // that the new glyph doesn't cover get the background color. Nothing is
+    // saved from under the glyphs: a sprite the label hid can have moved
+    // without the label seeing it.
+    Font* labelFont = label->font;
+    uint8_t bytesPerRow = (labelFont->width + 7) >> 3;
+    uint16_t glyphSize = bytesPerRow * labelFont->height;
+    uint8_t* oldGlyph = (oldChar != 0) ? labelFont->data + glyphSize * (uint8_t)oldChar : NULL;
+    uint8_t* newGlyph = (newChar != 0) ? labelFont->data + glyphSize * (uint8_t)newChar : NULL;
+    ClipRect view = clipRect;
+    uint8_t labelColor = label->color;
+    uint8_t backgroundColor = label->backgroundColor;
+    int16_t x = label->x + cell * labelFont->width + view.originX;
+    int16_t y = label->y + view.originY;
+    for(int v = 0; v < labelFont->height; v++) {
+        int16_t py = y + v;
+        if(py < view.top || py > view.bottom)
+            continue;
+        uint8_t* line = lineAddress(py);
+        int16_t first = view.right + 1;
+        int16_t last = -1;
+        for(int byte = 0; byte < bytesPerRow; byte++) {
+            // Only the pixels set in one of the glyphs can change
+            uint8_t oldBits = (oldGlyph != NULL) ? oldGlyph[bytesPerRow * v + byte] : 0;
+            uint8_t newBits = (newGlyph != NULL) ? newGlyph[bytesPerRow * v + byte] : 0;
+            uint8_t bits = oldBits | newBits;
+            for(int16_t px = x + byte * 8; bits != 0; px++, bits <<= 1, oldBits <<= 1, newBits <<= 1) {
+                if(!(bits & 0x80) || px < view.left || px > view.right)
+                    continue;
+                bool own = (oldBits & 0x80) && line[px] == labelColor;
+                if(newBits & 0x80) {
+                    if(own && labelColor == color)
+                        continue;
+                    line[px] = color;
+                } else if(own) {
+                    line[px] = backgroundColor;
+                } else {
+                    continue;
+                }
+                if(px < first)
+                    first = px;
+                last = px;
+            }
+        }
+
+        // Set dirty rectangles of the changed pixels
+        for(int i = DIRTY_RECT_X(first); i <= DIRTY_RECT_X(last); i++)
+            dirtyRects[py][i] = true;
+    }
+}
+
 void GFX::loadDefaultPalette() {
     memset(palette, 0, 512);
     palette[0] =  RGB565(0xFF, 0xFF, 0xFF); // White
@@ -961,6 +2741,58 @@ void GFX::loadDefaultPalette() {
     palette[15] = RGB565(0x00, 0x00, 0x00); // Black
 }
 
+void GFX::buildRemapTable(uint8_t* table, uint16_t size, uint8_t effect, float amount) {
+    // Fill a remap table for the first size colors of the palette. Every
+    // color is transformed and replaced by the closest of those colors, so the
+    // table has to be built again if the palette changes.
+    float c = fastCos(amount);
+    float s = fastSin(amount);
+    for(int i = 0; i < size; i++) {
+        int16_t r = (palette[i] >> 8) & 0xF8;
+        int16_t g = (palette[i] >> 3) & 0xFC;
+        int16_t b = (palette[i] << 3) & 0xF8;
+        if(effect == REMAP_WHITE) {
+            r = 255;
+            g = 255;
+            b = 255;
+        } else if(effect == REMAP_DARKEN) {
+            r = r * (1 - amount);
+            g = g * (1 - amount);
+            b = b * (1 - amount);
+        } else if(effect == REMAP_SHIFT_HUE) {
+            // Rotation around the gray axis, which keeps the luminance
+            // (the hueRotate matrix of SVG color filters)
+            float rf = r;
+            float gf = g;
+            float bf = b;
+            r = (0.213 + 0.787 * c - 0.213 * s) * rf + (0.715 - 0.715 * c - 0.715 * s) * gf + (0.072 - 0.072 * c + 0.928 * s) * bf;
+            g = (0.213 - 0.213 * c + 0.143 * s) * rf + (0.715 + 0.285 * c + 0.140 * s) * gf + (0.072 - 0.072 * c - 0.283 * s) * bf;
+            b = (0.213 - 0.213 * c - 0.787 * s) * rf + (0.715 - 0.715 * c + 0.715 * s) * gf + (0.072 + 0.928 * c + 0.072 * s) * bf;
+            r = (r < 0) ? 0 : (r > 255) ? 255 : r;
+            g = (g < 0) ? 0 : (g > 255) ? 255 : g;
+            b = (b < 0) ? 0 : (b > 255) ? 255 : b;
+        }
+        table[i] = closestColor(r, g, b, size);
+    }
+}
+
+uint8_t GFX::closestColor(int16_t r, int16_t g, int16_t b, uint16_t size) {
+    // Index of the closest color among the first size colors of the palette
+    uint8_t closest = 0;
+    int32_t closestDistance = 0x7FFFFFFF;
+    for(int i = 0; i < size; i++) {
+        int32_t dr = ((palette[i] >> 8) & 0xF8) - r;
+        int32_t dg = ((palette[i] >> 3) & 0xFC) - g;
+        int32_t db = ((palette[i] << 3) & 0xF8) - b;
+        int32_t distance = dr * dr + dg * dg + db * db;
+        if(distance < closestDistance) {
+            closest = i;
+            closestDistance = distance;
+        }
+    }
+    return closest;
+}
+
 void GFX::loadPalette(uint16_t* newPalette, int size) {
     memset(palette, 0, 512);
     memcpy(palette, newPalette, 2 * size);
@@ -0,0 +1,172 @@
+/* RotationCache.cpp */
+
+#include "RotationCache.h"
+
+RotationCache::RotationCache() {
+    // An empty cache, so begin can free the frames of a previous call
+    gfx = NULL;
+    budget = 0;
+    memoryUsed = 0;
+    step = 0;
+    angleCount = 0;
+    memset(buckets, 0, sizeof(buckets));
+    newest = NULL;
+    oldest = NULL;
+    resetStatistics();
+}
+
+bool RotationCache::begin(GFX* g, uint32_t memoryBudget, uint8_t angleStep) {
+    // Returns false if angleStep is 0. The budget should hold every frame
+    // drawn in a screen update: when it doesn't, most lookups miss, and a
+    // miss costs more than drawRotatedScaledBitmap. The frames cached by a
+    // previous call are freed.
+    if(angleStep == 0)
+        return false;
+    clear();
+    gfx = g;
+    budget = memoryBudget;
+    step = angleStep;
+    angleCount = (360 + angleStep - 1) / angleStep;
+    memoryUsed = 0;
+    memset(buckets, 0, sizeof(buckets));
+    newest = NULL;
+    oldest = NULL;
+    resetStatistics();
+    return true;
+}
+
+RotatedFrame* RotationCache::getFrame(uint8_t* source, uint16_t sourceWidth, uint16_t sourceHeight,
+            float scaleX, float scaleY, float rotation, uint8_t backgroundColor) {
+    // The returned frame stays valid until the next call to getFrame or clear.
+    // Returns NULL if the frame can't be allocated even with an empty cache.
+    // Quantize the rotation to the nearest cached angle
+    float angle = fmodf(rotation, 360);
+    if(angle < 0)
+        angle += 360;
+    uint16_t angleIndex = (uint16_t)(angle / step + 0.5) % angleCount;
+
+    // Look for the frame in the cache
+    uint16_t bucket = bucketIndex(source, angleIndex);
+    for(RotatedFrame* frame = buckets[bucket]; frame != NULL; frame = frame->nextInBucket) {
+        if(frame->source == source && frame->angleIndex == angleIndex &&
+                frame->sourceWidth == sourceWidth && frame->sourceHeight == sourceHeight &&
+                frame->scaleX == scaleX && frame->scaleY == scaleY &&
+                frame->backgroundColor == backgroundColor) {
+            // Hit: mark the frame as the most recently used
+            hits++;
+            unlink(frame);
+            pushNewest(frame);
+            return frame;
+        }
+    }
+
+    // Miss: render the frame, evicting the least recently used frames to stay
+    // within the memory budget. A frame bigger than the whole budget is kept
+    // anyway, since the caller needs it.
+    misses++;
+    float frameAngle = angleIndex * step;
+    uint16_t width, height;
+    gfx->getScaledAndRotatedSize(&width, &height, sourceWidth, sourceHeight, scaleX, scaleY, frameAngle);
+    uint32_t size = sizeof(RotatedFrame) + (uint32_t)width * height;
+    while(oldest != NULL && memoryUsed + size > budget)
+        evictOldest();
+    RotatedFrame* frame = (RotatedFrame*)malloc(size);
+    while(frame == NULL && oldest != NULL) {
+        evictOldest();
+        frame = (RotatedFrame*)malloc(size);
+    }
+    if(frame == NULL)
+        return NULL;
+
+    frame->pixels = (uint8_t*)(frame + 1);
+    frame->source = source;
+    frame->sourceWidth = sourceWidth;
+    frame->sourceHeight = sourceHeight;
+    frame->scaleX = scaleX;
+    frame->scaleY = scaleY;
+    frame->angleIndex = angleIndex;
+    frame->backgroundColor = backgroundColor;
+    frame->size = size;
+    gfx->scaleAndRotateBitmap(frame->pixels, &frame->width, &frame->height,
+            source, sourceWidth, sourceHeight, scaleX, scaleY, frameAngle, backgroundColor);
+
+    frame->nextInBucket = buckets[bucket];
+    buckets[bucket] = frame;
+    pushNewest(frame);
+    memoryUsed += size;
+    return frame;
+}
+
+void RotationCache::clear() {
+    while(oldest != NULL)
+        evictOldest();
+}
+
+void RotationCache::end() {
+    // Free every cached frame
+    clear();
+}
+
+uint32_t RotationCache::getHits() {
+    return hits;
+}
+
+uint32_t RotationCache::getMisses() {
+    return misses;
+}
+
+uint32_t RotationCache::getEvictions() {
+    return evictions;
+}
+
+uint32_t RotationCache::getMemoryUsed() {
+    return memoryUsed;
+}
+
+void RotationCache::resetStatistics() {
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+}
+
+uint16_t RotationCache::bucketIndex(uint8_t* source, uint16_t angleIndex) {
+    return (((uintptr_t)source >> 2) + angleIndex) % ROTATION_CACHE_BUCKETS;
+}
+
+void RotationCache::unlink(RotatedFrame* frame) {
+    // Remove the frame from the LRU list
+    if(frame->newer != NULL)
+        frame->newer->older = frame->older;
+    else
+        newest = frame->older;
+    if(frame->older != NULL)
+        frame->older->newer = frame->newer;
+    else
+        oldest = frame->newer;
+}
+
+void RotationCache::pushNewest(RotatedFrame* frame) {
+    // Insert the frame at the head of the LRU list
+    frame->newer = NULL;
+    frame->older = newest;
+    if(newest != NULL)
+        newest->newer = frame;
+    newest = frame;
+    if(oldest == NULL)
+        oldest = frame;
+}
+
+void RotationCache::evictOldest() {
+    RotatedFrame* frame = oldest;
+    unlink(frame);
+
+    // Remove the frame from its hash bucket
+    RotatedFrame** link = &buckets[bucketIndex(frame->source, frame->angleIndex)];
+    while(*link != frame)
+        link = &(*link)->nextInBucket;
+    *link = frame->nextInBucket;
+
+    memoryUsed -= frame->size;
+    evictions++;
+    free(frame);
+}
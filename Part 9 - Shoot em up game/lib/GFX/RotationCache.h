@@ -0,0 +1,65 @@
+/* RotationCache.h */
+
+#ifndef _ROTATION_CACHE_H
+#define _ROTATION_CACHE_H
+
+#include <Arduino.h>
+#include "GFX.h"
+
+#define ROTATION_CACHE_BUCKETS  32
+
+struct RotatedFrame {
+    uint8_t* pixels;
+    uint16_t width;
+    uint16_t height;
+
+    // Cache key
+    uint8_t* source;
+    uint16_t sourceWidth;
+    uint16_t sourceHeight;
+    float scaleX;
+    float scaleY;
+    uint16_t angleIndex;
+    uint8_t backgroundColor;
+
+    // Cache bookkeeping
+    uint32_t size;
+    RotatedFrame* nextInBucket;
+    RotatedFrame* newer;
+    RotatedFrame* older;
+};
+
+class RotationCache {
+    public:
+    RotationCache();
+    bool begin(GFX* g, uint32_t memoryBudget, uint8_t angleStep = 5);
+    void end();
+    RotatedFrame* getFrame(uint8_t* source, uint16_t sourceWidth, uint16_t sourceHeight,
+            float scaleX, float scaleY, float rotation, uint8_t backgroundColor);
+    void clear();
+    uint32_t getHits();
+    uint32_t getMisses();
+    uint32_t getEvictions();
+    uint32_t getMemoryUsed();
+    void resetStatistics();
+
+    private:
+    GFX* gfx;
+    uint32_t budget;
+    uint32_t memoryUsed;
+    uint8_t step;
+    uint16_t angleCount;
+    RotatedFrame* buckets[ROTATION_CACHE_BUCKETS];
+    RotatedFrame* newest;
+    RotatedFrame* oldest;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+
+    uint16_t bucketIndex(uint8_t* source, uint16_t angleIndex);
+    void unlink(RotatedFrame* frame);
+    void pushNewest(RotatedFrame* frame);
+    void evictOldest();
+};
+
+#endif
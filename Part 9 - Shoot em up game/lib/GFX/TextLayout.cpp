@@ -0,0 +1,207 @@
+/* TextLayout.cpp */
+
+#include "TextLayout.h"
+
+TextLayout::TextLayout() {
+    // No buffers until begin: draw does nothing
+    gfx = NULL;
+    font = NULL;
+    boxX = 0;
+    boxY = 0;
+    boxWidth = 320;
+    boxHeight = 0;
+    alignment = TEXT_ALIGN_LEFT;
+    scale = 1;
+    length = 0;
+    text = NULL;
+    glyphs = NULL;
+    glyphCount = 0;
+    lineCount = 0;
+    textWidth = 0;
+    valid = false;
+    layoutCount = 0;
+}
+
+bool TextLayout::begin(GFX* g, uint16_t maxLength) {
+    // The previous buffers are freed. Returns false if the buffers can't be
+    // allocated.
+    end();
+    gfx = g;
+    font = NULL;
+    boxX = 0;
+    boxY = 0;
+    boxWidth = 320;
+    boxHeight = 0;
+    alignment = TEXT_ALIGN_LEFT;
+    scale = 1;
+    glyphCount = 0;
+    lineCount = 0;
+    textWidth = 0;
+    valid = false;
+    layoutCount = 0;
+    text = (char*)malloc(maxLength + 1);
+    glyphs = (LayoutGlyph*)malloc(maxLength * sizeof(LayoutGlyph));
+    if(text == NULL || glyphs == NULL) {
+        free(text);
+        free(glyphs);
+        text = NULL;
+        glyphs = NULL;
+        length = 0;
+        return false;
+    }
+    length = maxLength;
+    return true;
+}
+
+void TextLayout::end() {
+    // Free the buffers
+    free(text);
+    free(glyphs);
+    text = NULL;
+    glyphs = NULL;
+    length = 0;
+    glyphCount = 0;
+    lineCount = 0;
+    textWidth = 0;
+    valid = false;
+}
+
+void TextLayout::setBox(int16_t x, int16_t y, uint16_t width, uint16_t height) {
+    // Glyph positions are relative to the box, so moving it keeps the layout
+    boxX = x;
+    boxY = y;
+    if(width != boxWidth || height != boxHeight) {
+        boxWidth = width;
+        boxHeight = height;
+        valid = false;
+    }
+}
+
+void TextLayout::setAlignment(uint8_t textAlignment) {
+    if(textAlignment != alignment) {
+        alignment = textAlignment;
+        valid = false;
+    }
+}
+
+void TextLayout::setScale(uint8_t textScale) {
+    if(textScale != scale) {
+        scale = textScale;
+        valid = false;
+    }
+}
+
+void TextLayout::draw(const char* string, uint8_t color) {
+    // Nothing to draw if begin couldn't allocate the buffers
+    if(text == NULL)
+        return;
+
+    // Lay out the text only if it changed since the last call
+    if(!valid || font != gfx->getFont() || strncmp(text, string, length) != 0)
+        layout(string);
+
+    for(int i = 0; i < glyphCount; i++) {
+        int16_t x = boxX + glyphs[i].x;
+        int16_t y = boxY + glyphs[i].y;
+        if(scale == 1)
+            gfx->drawChar(x, y, glyphs[i].character, color);
+        else if(scale == 2)
+            gfx->drawChar2x(x, y, glyphs[i].character, color);
+        else
+            gfx->drawCharScaled(x, y, glyphs[i].character, color, scale);
+    }
+}
+
+void TextLayout::invalidate() {
+    valid = false;
+}
+
+uint16_t TextLayout::getLineCount() {
+    return lineCount;
+}
+
+uint16_t TextLayout::getWidth() {
+    // Width of the widest laid out line
+    return textWidth;
+}
+
+uint16_t TextLayout::getHeight() {
+    if(font == NULL)
+        return 0;
+    return lineCount * font->height * scale;
+}
+
+uint32_t TextLayout::getLayoutCount() {
+    return layoutCount;
+}
+
+void TextLayout::layout(const char* string) {
+    // Word wrap the text to the box, breaking words longer than a line.
+    // Spaces are not stored, since they don't draw anything.
+    font = gfx->getFont();
+    strncpy(text, string, length);
+    text[length] = 0;
+    glyphCount = 0;
+    lineCount = 0;
+    textWidth = 0;
+    valid = true;
+    layoutCount++;
+
+    uint16_t charWidth = font->width * scale;
+    uint16_t lineHeight = font->height * scale;
+    int columns = boxWidth / charWidth;
+    if(columns < 1)
+        columns = 1;
+    int maxLines = (boxHeight > 0) ? boxHeight / lineHeight : 0x7FFF;
+
+    int i = 0;
+    while(text[i] != 0 && lineCount < maxLines) {
+        // Find the end of the line
+        int lineStart = i;
+        int lastSpace = -1;
+        int j = i;
+        while(text[j] != 0 && text[j] != '\n' && j - lineStart < columns) {
+            if(text[j] == ' ')
+                lastSpace = j;
+            j++;
+        }
+        int lineEnd = j;
+        int next = j;
+        if(text[j] == '\n') {
+            next = j + 1;
+        } else if(text[j] != 0) {
+            // The line is full: wrap at the last space, if there is one
+            if(text[j] != ' ' && lastSpace > lineStart)
+                lineEnd = lastSpace;
+            next = lineEnd;
+            while(text[next] == ' ')
+                next++;
+            if(text[next] == '\n')
+                next++;
+        }
+        while(lineEnd > lineStart && text[lineEnd - 1] == ' ')
+            lineEnd--;
+
+        // Align and store the glyphs
+        uint16_t lineWidth = (lineEnd - lineStart) * charWidth;
+        if(lineWidth > textWidth)
+            textWidth = lineWidth;
+        int16_t x = 0;
+        if(alignment == TEXT_ALIGN_CENTER)
+            x = ((int16_t)boxWidth - lineWidth) / 2;
+        else if(alignment == TEXT_ALIGN_RIGHT)
+            x = boxWidth - lineWidth;
+        int16_t y = lineCount * lineHeight;
+        for(int k = lineStart; k < lineEnd; k++, x += charWidth) {
+            if(text[k] != ' ') {
+                glyphs[glyphCount].x = x;
+                glyphs[glyphCount].y = y;
+                glyphs[glyphCount].character = text[k];
+                glyphCount++;
+            }
+        }
+
+        lineCount++;
+        i = next;
+    }
+}
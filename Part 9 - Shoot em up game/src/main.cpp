@@ -3,6 +3,8 @@
 #include <Arduino.h>
 #include <Adafruit_STMPE610.h>
 #include "GFX.h"
+#include "TextLayout.h"
+#include "CollisionMask.h"
 #include "bitmaps.h"
 #include "DefaultFont.h"
 
@@ -58,16 +60,22 @@ float asteroidSpeed = 70;
 float score;
 GameObject starship;
 GameObject farStar[FARSTAR_COUNT];
+Point farStarPoint[FARSTAR_COUNT];
+Point oldFarStarPoint[FARSTAR_COUNT];
+const uint8_t farStarColor[3] = {1, 7, 12};
 GameObject nearStar[NEARSTAR_COUNT];
 GameObject asteroid[MAX_ASTEROIDS];
 GameObject bullet[MAX_BULLETS];
 Explosion explosion[MAX_EXPLOSIONS];
+TextLabel scoreLabel;
+bool scoreLabelReady = false;
+TextLayout scoreLayout;
+uint8_t starshipBackground[32 * 32];
+CollisionMask starshipMask;
+CollisionMask asteroidMask;
+CollisionMask bulletMask;
 
 
-float distanceSquared(float x1, float y1, float x2, float y2) {
-  return (x1-x2)*(x1-x2)+(y1-y2)*(y1-y2);
-}
-
 bool createAsteroid(float x, float y) {
   for(int i=0; i<MAX_ASTEROIDS; i++) {
     if(!asteroid[i].valid) {
@@ -117,17 +125,14 @@ void setup() {
   starship.y = 230;
   starship.valid = false;
 
-  // Generate random far stars
+  // Generate random far stars, grouped by color so that every group can be
+  // drawn with a single call
   for(int i=0; i<FARSTAR_COUNT; i++) {
     farStar[i].x = esp_random() % 320;
     farStar[i].y = esp_random() % 320;
-    int rnd = esp_random() % 3;
-    if(rnd == 0)
-      farStar[i].color = 1;
-    else if(rnd == 1)
-      farStar[i].color = 7;
-    else
-      farStar[i].color = 12;
+    farStar[i].color = farStarColor[i * 3 / FARSTAR_COUNT];
+    farStarPoint[i].x = farStar[i].x;
+    farStarPoint[i].y = farStar[i].y;
   }
 
   // Generate random near stars
@@ -142,14 +147,26 @@ void setup() {
   // Start graphics library
   gfx.begin();
   gfx.setFont(&defaultFont);
+  scoreLabelReady = gfx.initTextLabel(&scoreLabel, 2, 2, 0, 15);
+
+  // Final score, centered on the game over screen
+  scoreLayout.begin(&gfx, 31);
+  scoreLayout.setBox(0, 116, 320, 32);
+  scoreLayout.setAlignment(TEXT_ALIGN_CENTER);
+  scoreLayout.setScale(2);
+
+  // Collision masks of the sprites
+  starshipMask.begin(starshipBitmap, 32, 32, 15);
+  asteroidMask.begin(asteroidBitmap, 32, 32, 0);
+  bulletMask.begin(bulletBitmap, 5, 5, 0);
 
   // Draw input area
   gfx.drawFilledRectangle(0, 320, 320, 160, 13);
   gfx.drawFilledRectangle(2, 322, 316, 156, 14);
 
   // Draw far stars
-  for(int i=0; i<FARSTAR_COUNT; i++)
-    gfx.drawPixel(farStar[i].x, farStar[i].y, farStar[i].color);
+  for(int i=0; i<3; i++)
+    gfx.drawPoints(farStarPoint + i * FARSTAR_COUNT / 3, FARSTAR_COUNT / 3, farStarColor[i]);
 
   // Draw near stars
   for(int i=0; i<NEARSTAR_COUNT; i++)
@@ -202,20 +219,19 @@ void loop() {
       if(createBullet(starship.x, starship.y - 16))
         lastFireTime = now;
     }
-
-    // Erase score
-    gfx.drawFilledRectangle(2, 2, 160, 16, 15);
   }
 
-  // We need to redraw input area?
-  bool redrawInputArea = false;
+  // Game objects are clipped to the play area, so they never draw over
+  // the input area
+  gfx.pushClipRect(0, 0, 320, 320);
 
 
   /*** ERASE GAME SCREEN ***/
 
-  // Erase starship
+  // Erase starship, putting back what was under it. It is drawn last, so it
+  // is erased first.
   if(starship.valid)
-    gfx.drawFilledRectangle(starship.x-16, starship.y-16, 32, 32, 15);
+    gfx.restoreSaveUnder(starshipBackground, starship.x-16, starship.y-16, 32, 32);
 
   // Erase bullets
   for(int i=0; i<MAX_BULLETS; i++) {
@@ -225,12 +241,8 @@ void loop() {
 
   // Erase asteroids
   for(int i=0; i<MAX_ASTEROIDS; i++) {
-    if(asteroid[i].valid) {
-      int height = 336 - asteroid[i].y;
-        if(height > 32)
-          height = 32;
-        gfx.drawFilledRectangle(asteroid[i].x-16, asteroid[i].y-16, 32, height, 15);
-    }
+    if(asteroid[i].valid)
+      gfx.drawFilledRectangle(asteroid[i].x-16, asteroid[i].y-16, 32, 32, 15);
   }
 
   // Erase explosions
@@ -238,11 +250,8 @@ void loop() {
     if(explosion[i].valid) {
       int x = explosion[i].x;
       int y = explosion[i].y;
-      for(int j=0; j<6; j++) {
-        if(y + explosion[i].circles[j].deltaY >= (320 - explosion[i].circles[j].radius))
-          redrawInputArea = true;
+      for(int j=0; j<6; j++)
         gfx.drawFilledCircle(x + explosion[i].circles[j].deltaX, y + explosion[i].circles[j].deltaY, explosion[i].circles[j].radius+2, 15);
-      }
     }
   }
 
@@ -250,10 +259,6 @@ void loop() {
   for(int i=0; i<NEARSTAR_COUNT; i++)
     gfx.drawFilledRectangle(nearStar[i].x, nearStar[i].y, 3, 3, 15);
 
-  // Erase far stars
-  for(int i=0; i<FARSTAR_COUNT; i++)
-    gfx.drawPixel(farStar[i].x, farStar[i].y, 15);
-
 
   /*** PROCESS INPUT ***/
 
@@ -316,12 +321,15 @@ void loop() {
   /*** UPDATE OBJECTS AND CHECK COLLISIONS ***/
 
   // Update stars position
+  memcpy(oldFarStarPoint, farStarPoint, sizeof(farStarPoint));
   for(int i=0; i<FARSTAR_COUNT; i++) {
     farStar[i].y += 12.0 * deltaTime;
     if(farStar[i].y >= 320) {
       farStar[i].y = 0;
       farStar[i].x = esp_random() % 320;
     }
+    farStarPoint[i].x = farStar[i].x;
+    farStarPoint[i].y = farStar[i].y;
   }
   for(int i=0; i<NEARSTAR_COUNT; i++) {
     nearStar[i].y += 36 * deltaTime;
@@ -371,7 +379,7 @@ void loop() {
   if(starship.valid) {
     for(int i=0; i<MAX_ASTEROIDS; i++) {
       if(asteroid[i].valid) {
-        if(distanceSquared(starship.x, starship.y, asteroid[i].x, asteroid[i].y) < 900) {
+        if(starshipMask.collides(starship.x-16, starship.y-16, &asteroidMask, asteroid[i].x-16, asteroid[i].y-16)) {
           // Create one explosion for the starship (with speed 0), and
           // an explosion for the asteroid (with current asteroid speed)
           createExplosion(starship.x, starship.y, 0);
@@ -391,7 +399,7 @@ void loop() {
       continue;
     for(int j=0; j<MAX_BULLETS; j++) {
       if(bullet[j].valid) {
-        if(distanceSquared(bullet[j].x, bullet[j].y, asteroid[i].x, asteroid[i].y) < 290) {
+        if(bulletMask.collides(bullet[j].x-2, bullet[j].y-2, &asteroidMask, asteroid[i].x-16, asteroid[i].y-16)) {
           if(gameState == Running)
             score += 200;
           createExplosion(asteroid[i].x, asteroid[i].y, asteroidSpeed);
@@ -406,9 +414,11 @@ void loop() {
 
   /*** REDRAW GAME SCREEN ***/
 
-  // Draw far stars
-  for(int i=0; i<FARSTAR_COUNT; i++)
-    gfx.drawPixel(farStar[i].x, farStar[i].y, farStar[i].color);
+  // Move far stars: only the ones that changed pixel are erased. Far stars
+  // are drawn first, when the other objects have already been erased.
+  for(int i=0; i<3; i++)
+    gfx.movePoints(oldFarStarPoint + i * FARSTAR_COUNT / 3, farStarPoint + i * FARSTAR_COUNT / 3,
+      FARSTAR_COUNT / 3, farStarColor[i], 15);
 
   // Draw near stars
   for(int i=0; i<NEARSTAR_COUNT; i++)
@@ -416,12 +426,8 @@ void loop() {
 
   // Draw asteroids
   for(int i=0; i<MAX_ASTEROIDS; i++) {
-    if(asteroid[i].valid) {
-      int height = 336 - asteroid[i].y;
-      if(height > 32)
-        height = 32;
-      gfx.drawTransparentBitmap(asteroidBitmap, asteroid[i].x-16, asteroid[i].y-16, 32, height, 0);
-    }
+    if(asteroid[i].valid)
+      gfx.drawTransparentBitmap(asteroidBitmap, asteroid[i].x-16, asteroid[i].y-16, 32, 32, 0);
   }
 
   // Draw bullets
@@ -449,9 +455,9 @@ void loop() {
     }
   }
 
-  // Draw starship
+  // Draw starship, saving the pixels under it
   if(starship.valid)
-    gfx.drawTransparentBitmap(starshipBitmap, starship.x-16, starship.y-16, 32, 32, 15);
+    gfx.drawTransparentBitmapSaveUnder(starshipBitmap, starship.x-16, starship.y-16, 32, 32, 15, starshipBackground);
 
   // Draw strings and buttons
   char buffer[32];
@@ -461,25 +467,29 @@ void loop() {
       break;
     
     case Running:
-      sprintf(buffer, "%d", (int)roundf(score));
-      gfx.drawString(2, 2, buffer, 0);
+      // Only the changed digits are redrawn. Without the label, the score
+      // is erased and drawn again.
+      formatInteger(buffer, roundf(score));
+      if(scoreLabelReady) {
+        gfx.drawTextLabel(&scoreLabel, 2, 2, buffer, 0);
+      } else {
+        gfx.drawFilledRectangle(2, 2, 160, 16, 15);
+        gfx.drawString(2, 2, buffer, 0);
+      }
       break;
 
     case GameOver:
-      sprintf(buffer, "SCORE: %d", (int)roundf(score));
+      strcpy(buffer, "SCORE: ");
+      formatInteger(buffer + 7, roundf(score));
       gfx.drawString2x(88, 80, "GAME OVER", 0);
-      gfx.drawString2x(160-8*strlen(buffer), 116, buffer, 0);
-      gfx.drawFilledRectangle(50, 170, 220, 64, 9);
-      gfx.drawRectangle(50, 170, 220, 64, 8);
+      scoreLayout.draw(buffer, 0);
+      gfx.drawFilledRoundedRectangle(50, 170, 220, 64, 12, 9);
+      gfx.drawRoundedRectangle(50, 170, 220, 64, 12, 8);
       gfx.drawString2x(80, 186, "PLAY AGAIN", 0);
       break;
   }
 
-  // Redraw top of the input area
-  if(redrawInputArea) {
-    gfx.drawFilledRectangle(0, 320, 320, 80, 13);
-    gfx.drawFilledRectangle(2, 322, 316, 78, 14);
-  }
+  gfx.popClipRect();
 
   // Update screen
   gfx.update();
@@ -0,0 +1,52 @@
+/* GFXTest.h */
+
+// Access to the screen buffer, the dirty map and the clipping state of GFX for
+// the host tests.
+// GFX.h makes this struct a friend when GFX_TEST is defined.
+
+#ifndef _GFX_TEST_H
+#define _GFX_TEST_H
+
+#include "GFX.h"
+
+struct GFXTest {
+    static uint8_t* lineAddress(GFX& gfx, int16_t y) {
+        return gfx.screenBuffer[SCREENBUFFER_SECTOR_2(y)] + 320 * (y & 0xFF);
+    }
+
+    static uint8_t getPixel(GFX& gfx, int16_t x, int16_t y) {
+        return lineAddress(gfx, y)[x];
+    }
+
+    static uint8_t (*dirtyRects(GFX& gfx))[5] {
+        return gfx.screenDirtyRects;
+    }
+
+    static bool isDirty(GFX& gfx, int16_t x, int16_t y) {
+        return gfx.screenDirtyRects[y][DIRTY_RECT_X(x)];
+    }
+
+    static void clearDirtyRects(GFX& gfx) {
+        memset(gfx.screenDirtyRects, 0, sizeof(gfx.screenDirtyRects));
+    }
+
+    static ClipRect clipRect(GFX& gfx) {
+        return gfx.clipRect;
+    }
+
+    static uint8_t clipStackSize(GFX& gfx) {
+        return gfx.clipStackSize;
+    }
+
+    static void copyScreen(GFX& destination, GFX& source) {
+        memcpy(destination.screenBuffer[0], source.screenBuffer[0], 81920);
+        memcpy(destination.screenBuffer[1], source.screenBuffer[1], 71680);
+    }
+
+    static bool sameScreen(GFX& a, GFX& b) {
+        return memcmp(a.screenBuffer[0], b.screenBuffer[0], 81920) == 0 &&
+                memcmp(a.screenBuffer[1], b.screenBuffer[1], 71680) == 0;
+    }
+};
+
+#endif
@@ -0,0 +1,91 @@
+/* RandomPrimitives.h */
+
+// Random calls to every drawing primitive, for the tests that draw the same
+// thing twice in different ways: call srand with the same seed before each
+// drawPrimitive to repeat the same call
+
+#ifndef _RANDOM_PRIMITIVES_H
+#define _RANDOM_PRIMITIVES_H
+
+#include "GFX.h"
+
+#define PRIMITIVES 29
+
+static uint8_t bitmap[64 * 64];
+static uint8_t monochrome[8 * 64];
+static uint8_t fontData[256 * 8];
+static Font font = { fontData, 8, 8 };
+
+inline int randomBetween(int low, int high) {
+    return low + rand() % (high - low + 1);
+}
+
+inline int16_t randomX() {
+    return randomBetween(-100, 420);
+}
+
+inline int16_t randomY() {
+    return randomBetween(-100, 580);
+}
+
+inline void initPrimitives() {
+    // Random bitmaps and font: the font must be set on every GFX that draws
+    for(int i = 0; i < 64 * 64; i++)
+        bitmap[i] = (rand() % 4 == 0) ? 0 : rand() % 16;
+    for(int i = 0; i < 8 * 64; i++)
+        monochrome[i] = rand();
+    for(int i = 0; i < 256 * 8; i++)
+        fontData[i] = rand();
+}
+
+inline void drawPrimitive(GFX& g, int primitive, uint8_t color) {
+    Point points[20];
+    Point moved[20];
+    for(int i = 0; i < 20; i++) {
+        points[i].x = randomX();
+        points[i].y = randomY();
+        moved[i].x = points[i].x + randomBetween(-1, 1);
+        moved[i].y = points[i].y + randomBetween(-1, 1);
+    }
+    int16_t x0 = randomX(), y0 = randomY(), x1 = randomX(), y1 = randomY(), x2 = randomX(), y2 = randomY();
+    uint16_t width = randomBetween(1, 200);
+    uint16_t height = randomBetween(1, 200);
+
+    switch(primitive) {
+        case 0: g.drawPixel(randomBetween(0, 319), randomBetween(0, 479), color); break;
+        case 1: g.drawPoints(points, 20, color); break;
+        case 2: g.drawPoints(points, 20, color); g.movePoints(points, moved, 20, color, color ^ 5); break;
+        case 3: g.drawHorizontalLine(x0, y0, width, color); break;
+        case 4: g.drawVerticalLine(x0, y0, height, color); break;
+        case 5: g.drawLine(x0, y0, x1, y1, color); break;
+        case 6: g.drawLine(x0, y0, x0 + randomBetween(-50, 50), y0, color); g.drawLine(x0, y0, x0, y0 + randomBetween(-50, 50), color); break;
+        case 7: g.drawThickLine(x0, y0, x1, y1, randomBetween(1, 12), color); break;
+        case 8: g.drawPolyline(points, 6, randomBetween(1, 9), color); break;
+        case 9: g.drawRectangle(x0, y0, width, height, color); break;
+        case 10: g.drawFilledRectangle(x0, y0, width, height, color); break;
+        case 11: g.drawTriangle(x0, y0, x1, y1, x2, y2, color); break;
+        case 12: g.drawFilledTriangle(x0, y0, x1, y1, x2, y2, color); break;
+        case 13: g.drawFilledPolygon(points, 7, color, randomBetween(0, 1)); break;
+        case 14: g.drawCircle(x0, y0, randomBetween(0, 100), color); break;
+        case 15: g.drawCircle(x0, y0, randomBetween(33, 150), color); break;
+        case 16: g.drawFilledCircle(x0, y0, randomBetween(0, 150), color); break;
+        case 17: g.drawEllipse(x0, y0, randomBetween(0, 100), randomBetween(0, 100), color); break;
+        case 18: g.drawFilledEllipse(x0, y0, randomBetween(0, 100), randomBetween(0, 100), color); break;
+        case 19: g.drawRoundedRectangle(x0, y0, width, height, randomBetween(0, 30), color); break;
+        case 20: g.drawFilledRoundedRectangle(x0, y0, width, height, randomBetween(0, 30), color); break;
+        case 21: g.drawArc(x0, y0, randomBetween(0, 150), randomBetween(0, 360), randomBetween(0, 720), color); break;
+        case 22: g.drawBitmap(bitmap, x0, y0, 64, 64, randomBetween(0, 3)); break;
+        case 23: g.drawTransparentBitmap(bitmap, x0, y0, 64, 64, 0, randomBetween(0, 3)); break;
+        case 24: g.drawRotatedScaledBitmap(bitmap, x0, y0, 64, 64, randomBetween(5, 20) / 10.0, randomBetween(5, 20) / 10.0, randomBetween(0, 359), 0); break;
+        case 25: g.drawMonochromeBitmap(monochrome, x0, y0, 64, 64, color); break;
+        case 26: g.drawMonochromeBitmap2x(monochrome, x0, y0, 64, 64, color); break;
+        case 27: g.drawMonochromeBitmapScaled(monochrome, x0, y0, 64, 64, color, randomBetween(1, 4)); break;
+        case 28:
+            g.drawString(x0, y0, "Hello\nWorld", color);
+            g.drawString2x(x1, y1, "AB\nC", color);
+            g.drawStringScaled(x2, y2, "xyz", color, 3);
+            break;
+    }
+}
+
+#endif
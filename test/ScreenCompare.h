@@ -0,0 +1,33 @@
+/* ScreenCompare.h */
+
+// Helpers to compare the screen buffer of GFX with the one of ReferenceGFX
+
+#ifndef _SCREEN_COMPARE_H
+#define _SCREEN_COMPARE_H
+
+#include "GFXTest.h"
+#include "ReferenceGFX.h"
+
+inline void clearDirtyRects(GFX& gfx) {
+    GFXTest::clearDirtyRects(gfx);
+}
+
+inline void clearDirtyRects(ReferenceGFX& reference) {
+    memset(reference.dirtyRects, 0, sizeof(reference.dirtyRects));
+}
+
+// True if the pixels are the same and every cell marked dirty by the
+// reference is also dirty in gfx (gfx may mark more cells)
+inline bool sameScreen(GFX& gfx, ReferenceGFX& reference) {
+    if(memcmp(GFXTest::lineAddress(gfx, 0), reference.screenBuffer[0], 81920) != 0)
+        return false;
+    if(memcmp(GFXTest::lineAddress(gfx, 256), reference.screenBuffer[1], 71680) != 0)
+        return false;
+    for(int y = 0; y < 480; y++)
+        for(int x = 0; x < 5; x++)
+            if(reference.dirtyRects[y][x] && !GFXTest::dirtyRects(gfx)[y][x])
+                return false;
+    return true;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/* bench_circles.cpp */
+
+// drawFilledCircle against the reference, which draws four spans per
+// midpoint step. Random circles, clipped at every screen edge, must give
+// the same pixels. Then the Part 9 explosion workload and single radii are
+// timed, best of 5 runs.
+
+#include <stdio.h>
+#include "ScreenCompare.h"
+
+#define EXPLOSIONS  5
+#define CIRCLES     6       // Circles per explosion
+#define FRAMES      5000
+
+GFX gfx;
+ReferenceGFX reference;
+
+struct Circle {
+    int16_t x;
+    int16_t y;
+    float scale;
+};
+
+Circle circles[EXPLOSIONS * CIRCLES];
+
+template<class G> double explosions(G& g) {
+    // Every frame erases the circles with radius + 2, like Part 9, and draws
+    // them again with the radius growing from 2 to 22 over 60 frames
+    unsigned long start = micros();
+    for(int f = 0; f < FRAMES; f++) {
+        float radius = 2 + 20 * ((f % 60) / 60.0f);
+        for(int i = 0; i < EXPLOSIONS * CIRCLES; i++)
+            g.drawFilledCircle(circles[i].x, circles[i].y, radius * circles[i].scale + 2, 15);
+        for(int i = 0; i < EXPLOSIONS * CIRCLES; i++)
+            g.drawFilledCircle(circles[i].x, circles[i].y, radius * circles[i].scale, 1 + i % 3);
+    }
+    return (double)(micros() - start) / FRAMES;
+}
+
+template<class G> double circle(G& g, uint16_t radius, int runs) {
+    unsigned long start = micros();
+    for(int i = 0; i < runs; i++)
+        g.drawFilledCircle(100 + (i & 63), 200, radius, i & 7);
+    return (double)(micros() - start) / runs;
+}
+
+int main() {
+    gfx.begin();
+    reference.begin();
+    gfx.fillScreen(0);
+    reference.fillScreen(0);
+    clearDirtyRects(gfx);
+    clearDirtyRects(reference);
+
+    for(int radius = 0; radius < 300; radius++) {
+        gfx.drawFilledCircle(160, 240, radius, radius & 255);
+        reference.drawFilledCircle(160, 240, radius, radius & 255);
+    }
+    srand(1);
+    for(int i = 0; i < 100000; i++) {
+        int radius = rand() % ((i % 10) ? 30 : 300);
+        int16_t x = rand() % (320 + 4 * radius) - 2 * radius;
+        int16_t y = rand() % (480 + 4 * radius) - 2 * radius;
+        uint8_t color = rand() & 255;
+        gfx.drawFilledCircle(x, y, radius, color);
+        reference.drawFilledCircle(x, y, radius, color);
+        if(i % 100 == 0 && !sameScreen(gfx, reference)) {
+            printf("FAIL radius %d at %d,%d\n", radius, x, y);
+            return 1;
+        }
+    }
+    if(!sameScreen(gfx, reference)) {
+        puts("FAIL");
+        return 1;
+    }
+    puts("100000 clipped circles identical to the reference");
+
+    for(int i = 0; i < EXPLOSIONS * CIRCLES; i++) {
+        Circle* c = &circles[i];
+        c->x = (rand() % 320) + rand() % 30 - 15;
+        c->y = (rand() % 320) + rand() % 30 - 15;
+        c->scale = 0.6f + 0.08f * (i % CIRCLES);
+    }
+    double referenceTime = 1e9, time = 1e9;
+    for(int run = 0; run < 5; run++) {
+        referenceTime = min(referenceTime, explosions(reference));
+        time = min(time, explosions(gfx));
+    }
+    printf("explosions (60 circles per frame): reference %.2f us, new %.2f us (%.2fx)\n",
+            referenceTime, time, referenceTime / time);
+
+    const uint16_t radii[] = {2, 8, 22, 100};
+    for(uint16_t radius : radii) {
+        int runs = (radius > 50) ? 20000 : 200000;
+        referenceTime = 1e9;
+        time = 1e9;
+        for(int run = 0; run < 5; run++) {
+            referenceTime = min(referenceTime, circle(reference, radius, runs));
+            time = min(time, circle(gfx, radius, runs));
+        }
+        printf("radius %3d: reference %.3f us, new %.3f us (%.2fx)\n", radius, referenceTime, time, referenceTime / time);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+/* bench_glyphs.cpp */
+
+// The span glyph renderer against the per-pixel reference: random clipped
+// monochrome bitmaps must give the same pixels, then a full 40 column line
+// of text is timed, also with the default font converted to a proportional
+// font, whose glyphs are cropped and don't start on a byte of the screen.
+
+#include <stdio.h>
+#include "ScreenCompare.h"
+#include "DefaultFont.h"
+#include "fonts/ConvertedFont.h"
+
+#define RUNS 20000
+
+GFX gfx;
+ReferenceGFX reference;
+uint8_t bitmap[4 * 40];
+
+int main() {
+    gfx.begin();
+    reference.begin();
+    gfx.setFont(&defaultFont);
+    reference.setFont(&defaultFont);
+    gfx.fillScreen(0);
+    reference.fillScreen(0);
+    clearDirtyRects(gfx);
+    clearDirtyRects(reference);
+
+    srand(1);
+    for(int i = 0; i < 20000; i++) {
+        uint16_t width = rand() % 30 + 1;
+        uint16_t height = rand() % 40 + 1;
+        for(int j = 0; j < (int)sizeof(bitmap); j++)
+            bitmap[j] = (rand() % 3) ? rand() & 0xFF : (rand() & 1) * 0xFF;
+        int16_t x = rand() % 400 - 60;
+        int16_t y = rand() % 560 - 60;
+        uint8_t color = rand() % 16;
+        gfx.drawMonochromeBitmap(bitmap, x, y, width, height, color);
+        reference.drawMonochromeBitmap(bitmap, x, y, width, height, color);
+        if(!sameScreen(gfx, reference)) {
+            printf("FAIL %dx%d bitmap at %d,%d\n", width, height, x, y);
+            return 1;
+        }
+    }
+    puts("20000 clipped bitmaps identical to the reference");
+
+    const char* line = "The quick brown fox jumps over the lazy";
+    unsigned long start = micros();
+    for(int i = 0; i < RUNS; i++)
+        reference.drawString(0, (i % 29) * 16, line, i & 15);
+    double referenceTime = (double)(micros() - start) / RUNS;
+    start = micros();
+    for(int i = 0; i < RUNS; i++)
+        gfx.drawString(0, (i % 29) * 16, line, i & 15);
+    double time = (double)(micros() - start) / RUNS;
+    printf("40 column line: reference %.2f us, span renderer %.2f us (%.1fx)\n",
+            referenceTime, time, referenceTime / time);
+
+    gfx.setProportionalFont(&convertedFont);
+    start = micros();
+    for(int i = 0; i < RUNS; i++)
+        gfx.drawProportionalString(0, (i % 29) * 16, line, i & 15);
+    double proportionalTime = (double)(micros() - start) / RUNS;
+    printf("40 column line: drawString %.2f us, drawProportionalString %.2f us\n", time, proportionalTime);
+    return 0;
+}
@@ -0,0 +1,132 @@
+/* bench_points.cpp */
+
+// drawPoints and movePoints against drawPixel for a scrolling starfield.
+// drawPoints must match drawPixel on the visible points, then each star
+// count is timed for erase + move + draw of one frame.
+
+#include <stdio.h>
+#include <vector>
+#include "ScreenCompare.h"
+
+GFX gfx;
+ReferenceGFX reference;
+
+int countDirtyRects(uint8_t (*dirtyRects)[5]) {
+    int count = 0;
+    for(int y = 0; y < 480; y++)
+        for(int x = 0; x < 5; x++)
+            count += (dirtyRects[y][x] != 0);
+    return count;
+}
+
+int main() {
+    gfx.begin();
+    reference.begin();
+    gfx.fillScreen(15);
+    reference.fillScreen(15);
+    clearDirtyRects(gfx);
+    clearDirtyRects(reference);
+
+    // The reference drawPixel doesn't clip: skip the off-screen points
+    srand(1);
+    std::vector<Point> points(5000);
+    for(size_t i = 0; i < points.size(); i++) {
+        points[i].x = rand() % 400 - 40;
+        points[i].y = rand() % 560 - 40;
+    }
+    gfx.drawPoints(points.data(), points.size(), 3);
+    for(size_t i = 0; i < points.size(); i++)
+        if(points[i].x >= 0 && points[i].x < 320 && points[i].y >= 0 && points[i].y < 480)
+            reference.drawPixel(points[i].x, points[i].y, 3);
+    if(!sameScreen(gfx, reference)) {
+        puts("FAIL drawPoints differs from drawPixel");
+        return 1;
+    }
+    puts("drawPoints matches drawPixel on 5000 points, partly off-screen");
+
+    const int counts[] = {60, 1000, 10000};
+    for(int n : counts) {
+        int frames = (n > 5000) ? 200 : 2000;
+        std::vector<float> x(n), y(n);
+        std::vector<Point> current(n), previous(n);
+        for(int i = 0; i < n; i++) {
+            x[i] = rand() % 320;
+            y[i] = rand() % 320;
+            current[i].x = x[i];
+            current[i].y = y[i];
+        }
+
+        // Dirty cells per frame, averaged over 100 frames
+        long referenceDirty = 0, moveDirty = 0;
+        for(int f = 0; f < 100; f++) {
+            clearDirtyRects(reference);
+            clearDirtyRects(gfx);
+            previous.swap(current);
+            for(int i = 0; i < n; i++) {
+                reference.drawPixel(previous[i].x, previous[i].y, 15);
+                y[i] += 0.24f;
+                if(y[i] >= 320)
+                    y[i] = 0;
+                current[i].x = x[i];
+                current[i].y = y[i];
+                reference.drawPixel(current[i].x, current[i].y, 1);
+            }
+            gfx.movePoints(previous.data(), current.data(), n, 1, 15);
+            referenceDirty += countDirtyRects(reference.dirtyRects);
+            moveDirty += countDirtyRects(GFXTest::dirtyRects(gfx));
+        }
+
+        double referenceTime = 1e9, drawTime = 1e9, moveTime = 1e9;
+        for(int run = 0; run < 5; run++) {
+            // drawPixel: erase every star, move, draw every star
+            unsigned long start = micros();
+            for(int f = 0; f < frames; f++) {
+                for(int i = 0; i < n; i++)
+                    reference.drawPixel(x[i], y[i], 15);
+                for(int i = 0; i < n; i++) {
+                    y[i] += 0.24f;
+                    if(y[i] >= 320)
+                        y[i] = 0;
+                }
+                for(int i = 0; i < n; i++)
+                    reference.drawPixel(x[i], y[i], 1 + i % 3);
+            }
+            referenceTime = min(referenceTime, (double)(micros() - start) / frames);
+
+            // drawPoints: erase the previous points, move, draw in three colors
+            start = micros();
+            for(int f = 0; f < frames; f++) {
+                gfx.drawPoints(current.data(), n, 15);
+                for(int i = 0; i < n; i++) {
+                    y[i] += 0.24f;
+                    if(y[i] >= 320)
+                        y[i] = 0;
+                    current[i].y = y[i];
+                }
+                for(int c = 0; c < 3; c++)
+                    gfx.drawPoints(current.data() + c * n / 3, (c + 1) * n / 3 - c * n / 3, 1 + c);
+            }
+            drawTime = min(drawTime, (double)(micros() - start) / frames);
+
+            // movePoints: only the stars that changed pixel are erased
+            start = micros();
+            for(int f = 0; f < frames; f++) {
+                previous.swap(current);
+                for(int i = 0; i < n; i++) {
+                    y[i] += 0.24f;
+                    if(y[i] >= 320)
+                        y[i] = 0;
+                    current[i].x = x[i];
+                    current[i].y = y[i];
+                }
+                gfx.movePoints(previous.data(), current.data(), n, 1, 15);
+            }
+            moveTime = min(moveTime, (double)(micros() - start) / frames);
+        }
+        printf("%5d stars per frame: drawPixel %.2f us, drawPoints %.2f us (%.1fx), movePoints %.2f us (%.1fx); "
+                "dirty cells drawPixel %ld, movePoints %ld\n",
+                n, referenceTime, drawTime, referenceTime / drawTime, moveTime, referenceTime / moveTime,
+                referenceDirty / 100, moveDirty / 100);
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+/* bench_polygons.cpp */
+
+// drawFilledPolygon against a brute-force reference that tests every pixel
+// of random polygons with the even-odd and non-zero rules. A convex polygon
+// must be covered by its triangle fan, which also draws the right and
+// bottom edges. Then convex polygons are timed against their fans, best of
+// 5 runs.
+
+#include <stdio.h>
+#include <math.h>
+#include "GFXTest.h"
+
+#define POLYGONS    500
+#define MAX_POINTS  32
+
+GFX gfx;
+
+uint8_t getPixel(int16_t x, int16_t y) {
+    return GFXTest::getPixel(gfx, x, y);
+}
+
+bool inside(const Point* points, int count, int16_t x, int16_t y, uint8_t fillRule) {
+    // Crossings of the edges left of or at (x, y), with the top row of an
+    // edge included and the bottom one excluded
+    int crossings = 0;
+    int winding = 0;
+    for(int i = 0; i < count; i++) {
+        Point a = points[i];
+        Point b = points[(i + 1) % count];
+        if(a.y == b.y)
+            continue;
+        int direction = 1;
+        if(a.y > b.y) {
+            Point t = a;
+            a = b;
+            b = t;
+            direction = -1;
+        }
+        if(y < a.y || y >= b.y)
+            continue;
+        int64_t dy = b.y - a.y;
+        if((int64_t)a.x * dy + (int64_t)(y - a.y) * (b.x - a.x) <= (int64_t)x * dy) {
+            crossings++;
+            winding += direction;
+        }
+    }
+    return (fillRule == FILL_NONZERO) ? winding != 0 : (crossings & 1) != 0;
+}
+
+void regularPolygon(Point* points, int count, int16_t x, int16_t y, int16_t radius, float phase) {
+    for(int i = 0; i < count; i++) {
+        float angle = 2 * M_PI * i / count + phase;
+        points[i].x = x + radius * cos(angle);
+        points[i].y = y + radius * sin(angle);
+    }
+}
+
+void drawFan(const Point* points, int count, uint8_t color) {
+    for(int i = 1; i + 1 < count; i++)
+        gfx.drawFilledTriangle(points[0].x, points[0].y, points[i].x, points[i].y, points[i + 1].x, points[i + 1].y, color);
+}
+
+int main() {
+    gfx.begin();
+    Point points[MAX_POINTS];
+
+    srand(1);
+    for(int i = 0; i < 1000; i++) {
+        int count = 3 + rand() % ((i & 2) ? MAX_POINTS - 3 : 6);
+        int size = (i % 3 == 0) ? 700 : ((i % 3 == 1) ? 100 : 10);
+        int16_t x = rand() % 320;
+        int16_t y = rand() % 480;
+        for(int k = 0; k < count; k++) {
+            points[k].x = x + rand() % size - size / 2;
+            points[k].y = y + rand() % size - size / 2;
+        }
+        if(i % 5 == 0)
+            points[1].y = points[0].y;
+        uint8_t fillRule = (i & 1) ? FILL_NONZERO : FILL_EVEN_ODD;
+        gfx.fillScreen(0);
+        GFXTest::clearDirtyRects(gfx);
+        gfx.drawFilledPolygon(points, count, 1, fillRule);
+        for(int16_t py = 0; py < 480; py++) {
+            for(int16_t px = 0; px < 320; px++) {
+                bool expected = inside(points, count, px, py, fillRule);
+                if(expected != (getPixel(px, py) == 1) || (expected && !GFXTest::isDirty(gfx, px, py))) {
+                    printf("FAIL polygon %d (%d points) at %d,%d\n", i, count, px, py);
+                    return 1;
+                }
+            }
+        }
+    }
+    puts("1000 random polygons match the even-odd and non-zero reference");
+
+    static uint8_t fan[480][320];
+    for(int i = 0; i < 300; i++) {
+        int count = 3 + rand() % 14;
+        regularPolygon(points, count, rand() % 400 - 40, rand() % 560 - 40, 5 + rand() % 250, 0.3f + i);
+        gfx.fillScreen(0);
+        drawFan(points, count, 1);
+        for(int16_t py = 0; py < 480; py++)
+            for(int16_t px = 0; px < 320; px++)
+                fan[py][px] = getPixel(px, py);
+        gfx.fillScreen(0);
+        gfx.drawFilledPolygon(points, count, 1);
+        for(int16_t py = 0; py < 480; py++) {
+            for(int16_t px = 0; px < 320; px++) {
+                if(getPixel(px, py) != fan[py][px]) {
+                    printf("FAIL convex polygon %d differs from its fan at %d,%d\n", i, px, py);
+                    return 1;
+                }
+            }
+        }
+    }
+    puts("300 convex polygons identical to their triangle fans");
+
+    static Point polygons[POLYGONS][MAX_POINTS];
+    const int counts[] = {5, 8, 12, 16, 32};
+    const int16_t radii[] = {20, 100};
+    for(int count : counts) {
+        for(int16_t radius : radii) {
+            for(int i = 0; i < POLYGONS; i++)
+                regularPolygon(polygons[i], count, rand() % 320, rand() % 480, radius, 0);
+            double fanTime = 1e9, polygonTime = 1e9;
+            for(int run = 0; run < 5; run++) {
+                unsigned long start = micros();
+                for(int i = 0; i < POLYGONS; i++)
+                    drawFan(polygons[i], count, 3);
+                fanTime = min(fanTime, (double)(micros() - start));
+                start = micros();
+                for(int i = 0; i < POLYGONS; i++)
+                    gfx.drawFilledPolygon(polygons[i], count, 3);
+                polygonTime = min(polygonTime, (double)(micros() - start));
+            }
+            printf("%d convex %2d-gons, radius %3d: fan %6.0f us, polygon %6.0f us (%.2fx)\n",
+                    POLYGONS, count, radius, fanTime, polygonTime, fanTime / polygonTime);
+        }
+    }
+    return 0;
+}
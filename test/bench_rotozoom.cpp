@@ -0,0 +1,144 @@
+/* bench_rotozoom.cpp */
+
+// The 20 starships of the Part 7 demo, replayed from the same motion on
+// three paths:
+//   reference:  scaleAndRotateBitmap + copyScreenBufferRect + drawTransparentBitmap
+//   direct:     copyScreenBufferRect + drawRotatedScaledBitmap (the demo)
+//   cache:      RotationCache frame + drawTransparentBitmapSaveUnder
+// Each ship is erased with drawBitmap in reverse order, as in the demo.
+
+#include <stdio.h>
+#include "GFX.h"
+#include "ReferenceGFX.h"
+#include "RotationCache.h"
+#include "../Part 7 - Graphics library optimization/include/bitmaps.h"
+
+#define STARSHIP_COUNT  20
+#define FRAMES          2000
+
+struct Position {
+    int16_t x;
+    int16_t y;
+    float theta;
+};
+
+Position positions[FRAMES][STARSHIP_COUNT];
+uint16_t widths[STARSHIP_COUNT];
+uint16_t heights[STARSHIP_COUNT];
+uint8_t backgrounds[STARSHIP_COUNT][4624];
+uint8_t rotated[4624];
+
+GFX gfx;
+ReferenceGFX reference;
+RotationCache cache;
+
+void simulate() {
+    // The motion of the demo loop at a fixed 30 fps
+    float x[STARSHIP_COUNT], y[STARSHIP_COUNT], theta[STARSHIP_COUNT];
+    float xTarget[STARSHIP_COUNT], yTarget[STARSHIP_COUNT];
+    srand(1);
+    for(int i = 0; i < STARSHIP_COUNT; i++) {
+        x[i] = 30 + rand() % 260;
+        y[i] = 30 + rand() % 420;
+        theta[i] = rand() % 360;
+        xTarget[i] = rand() % 320;
+        yTarget[i] = rand() % 480;
+    }
+    float deltaTime = 1.0f / 30;
+    for(int f = 0; f < FRAMES; f++) {
+        for(int i = 0; i < STARSHIP_COUNT; i++) {
+            float thetaTarget = fastAtan2(yTarget[i] - y[i], xTarget[i] - x[i]) + 90;
+            if(fabs(thetaTarget - theta[i]) > 180)
+                theta[i] += (theta[i] < 0) ? 360 : -360;
+            theta[i] += max(min(3 * (int)(thetaTarget - theta[i]), 180), -180) * deltaTime;
+            float slowdown = 1 / (1 + 0.1 * fabs(thetaTarget - theta[i]));
+            x[i] += 0.5 * (xTarget[i] - x[i]) * slowdown * deltaTime;
+            y[i] += 0.5 * (yTarget[i] - y[i]) * slowdown * deltaTime;
+            if(fabs(x[i] - xTarget[i]) < 40 && fabs(y[i] - yTarget[i]) < 40) {
+                xTarget[i] = rand() % 320;
+                yTarget[i] = rand() % 480;
+            }
+            positions[f][i].x = x[i];
+            positions[f][i].y = y[i];
+            positions[f][i].theta = theta[i];
+        }
+    }
+}
+
+double runReference() {
+    reference.fillScreen(0);
+    unsigned long start = micros();
+    for(int f = 0; f < FRAMES; f++) {
+        for(int i = STARSHIP_COUNT - 1; f > 0 && i >= 0; i--) {
+            Position* p = &positions[f - 1][i];
+            reference.drawBitmap(backgrounds[i], p->x - widths[i] / 2, p->y - heights[i] / 2, widths[i], heights[i]);
+        }
+        for(int i = 0; i < STARSHIP_COUNT; i++) {
+            Position* p = &positions[f][i];
+            reference.scaleAndRotateBitmap(rotated, &widths[i], &heights[i], starship, 32, 32, 1.5, 1.5, p->theta, 15);
+            reference.copyScreenBufferRect(backgrounds[i], p->x - widths[i] / 2, p->y - heights[i] / 2, widths[i], heights[i]);
+            reference.drawTransparentBitmap(rotated, p->x - widths[i] / 2, p->y - heights[i] / 2, widths[i], heights[i], 15);
+        }
+    }
+    return (double)(micros() - start) / FRAMES;
+}
+
+double runDirect() {
+    gfx.fillScreen(0);
+    unsigned long start = micros();
+    for(int f = 0; f < FRAMES; f++) {
+        for(int i = STARSHIP_COUNT - 1; f > 0 && i >= 0; i--) {
+            Position* p = &positions[f - 1][i];
+            gfx.drawBitmap(backgrounds[i], p->x - widths[i] / 2, p->y - heights[i] / 2, widths[i], heights[i]);
+        }
+        for(int i = 0; i < STARSHIP_COUNT; i++) {
+            Position* p = &positions[f][i];
+            gfx.getScaledAndRotatedSize(&widths[i], &heights[i], 32, 32, 1.5, 1.5, p->theta);
+            gfx.copyScreenBufferRect(backgrounds[i], p->x - widths[i] / 2, p->y - heights[i] / 2, widths[i], heights[i]);
+            gfx.drawRotatedScaledBitmap(starship, p->x - widths[i] / 2, p->y - heights[i] / 2, 32, 32, 1.5, 1.5, p->theta, 15);
+        }
+    }
+    return (double)(micros() - start) / FRAMES;
+}
+
+double runCache(uint32_t budget, uint8_t step) {
+    gfx.fillScreen(0);
+    cache.begin(&gfx, budget, step);
+    unsigned long start = micros();
+    for(int f = 0; f < FRAMES; f++) {
+        for(int i = STARSHIP_COUNT - 1; f > 0 && i >= 0; i--) {
+            Position* p = &positions[f - 1][i];
+            gfx.restoreSaveUnder(backgrounds[i], p->x - widths[i] / 2, p->y - heights[i] / 2, widths[i], heights[i]);
+        }
+        for(int i = 0; i < STARSHIP_COUNT; i++) {
+            Position* p = &positions[f][i];
+            RotatedFrame* frame = cache.getFrame(starship, 32, 32, 1.5, 1.5, p->theta, 15);
+            widths[i] = frame->width;
+            heights[i] = frame->height;
+            gfx.drawTransparentBitmapSaveUnder(frame->pixels, p->x - widths[i] / 2, p->y - heights[i] / 2, widths[i], heights[i], 15, backgrounds[i]);
+        }
+    }
+    double time = (double)(micros() - start) / FRAMES;
+    cache.clear();
+    return time;
+}
+
+int main() {
+    gfx.begin();
+    reference.begin();
+    simulate();
+
+    double referenceTime = runReference();
+    double directTime = runDirect();
+    printf("20 ships, 1.5x: reference %.1f us/frame, direct %.1f us/frame (%.2fx)\n",
+            referenceTime, directTime, referenceTime / directTime);
+    const uint32_t budgets[] = {49152, 49152, 262144};
+    const uint8_t steps[] = {10, 5, 5};
+    for(int k = 0; k < 3; k++) {
+        double cacheTime = runCache(budgets[k], steps[k]);
+        uint32_t lookups = cache.getHits() + cache.getMisses();
+        printf("cache %3u KB, %2d degree steps: %.1f us/frame, %.0f%% hits (%.2fx of direct)\n",
+                budgets[k] / 1024, steps[k], cacheTime, 100.0 * cache.getHits() / lookups, directTime / cacheTime);
+    }
+    return 0;
+}
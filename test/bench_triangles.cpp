@@ -0,0 +1,159 @@
+/* bench_triangles.cpp */
+
+// drawFilledTriangle against a brute-force reference that tests every pixel
+// with the top-left fill rule. Random triangles, clipped at every screen
+// edge and including flat and degenerate ones, must give the same pixels and
+// mark them dirty, and the triangles of a fan must never overlap. Then 1000
+// random triangles of each size are timed against ReferenceGFX, which
+// divides twice per row, best of 5 runs: size 1000 is mostly clipped.
+
+#include <stdio.h>
+#include <math.h>
+#include "ScreenCompare.h"
+
+#define TRIANGLES   1000
+
+GFX gfx;
+ReferenceGFX reference;
+
+struct Triangle {
+    int16_t x[3];
+    int16_t y[3];
+};
+
+Triangle triangles[TRIANGLES];
+
+void randomTriangle(Triangle* t, int size) {
+    // Vertices within size pixels of a random point of the screen, or
+    // anywhere on the screen if size is 0
+    int16_t cx = rand() % 320;
+    int16_t cy = rand() % 480;
+    for(int i = 0; i < 3; i++) {
+        t->x[i] = size ? cx + rand() % (size + 1) - size / 2 : rand() % 320;
+        t->y[i] = size ? cy + rand() % (size + 1) - size / 2 : rand() % 480;
+    }
+}
+
+bool inside(const Triangle* t, int16_t x, int16_t y) {
+    // (x, y) is inside every edge of the clockwise triangle, or on a left
+    // edge (going up) or a top edge (horizontal, going right)
+    int64_t area = (int64_t)(t->x[1] - t->x[0]) * (t->y[2] - t->y[0]) - (int64_t)(t->x[2] - t->x[0]) * (t->y[1] - t->y[0]);
+    if(area == 0)
+        return false;
+    int order[3] = {0, 1, 2};
+    if(area < 0) {
+        order[1] = 2;
+        order[2] = 1;
+    }
+    for(int i = 0; i < 3; i++) {
+        int64_t ax = t->x[order[i]], ay = t->y[order[i]];
+        int64_t bx = t->x[order[(i + 1) % 3]], by = t->y[order[(i + 1) % 3]];
+        int64_t side = (bx - ax) * (y - ay) - (by - ay) * (x - ax);
+        if(side < 0)
+            return false;
+        if(side == 0 && !(by < ay || (by == ay && bx > ax)))
+            return false;
+    }
+    return true;
+}
+
+bool drawnLikeReference(const Triangle* t) {
+    for(int16_t y = 0; y < 480; y++) {
+        for(int16_t x = 0; x < 320; x++) {
+            bool expected = inside(t, x, y);
+            if(expected != (GFXTest::getPixel(gfx, x, y) == 1) || (expected && !GFXTest::isDirty(gfx, x, y))) {
+                printf("FAIL %d,%d %d,%d %d,%d at %d,%d\n", t->x[0], t->y[0], t->x[1], t->y[1], t->x[2], t->y[2], x, y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<class G> double triangles1000(G& g) {
+    unsigned long start = micros();
+    for(int i = 0; i < TRIANGLES; i++) {
+        Triangle* t = &triangles[i];
+        g.drawFilledTriangle(t->x[0], t->y[0], t->x[1], t->y[1], t->x[2], t->y[2], i & 255);
+    }
+    return (double)(micros() - start);
+}
+
+int main() {
+    gfx.begin();
+    reference.begin();
+    gfx.fillScreen(0);
+    reference.fillScreen(0);
+    clearDirtyRects(gfx);
+    clearDirtyRects(reference);
+
+    srand(1);
+    const int sizes[] = {4, 8, 20, 100, 320, 1000};
+    for(int i = 0; i < 3000; i++) {
+        Triangle t;
+        randomTriangle(&t, sizes[i % 6]);
+        if(i % 7 == 0)
+            t.y[1] = t.y[0];    // Flat top or bottom
+        if(i % 11 == 0) {
+            t.x[2] = 2 * t.x[1] - t.x[0];   // Degenerate: a line
+            t.y[2] = 2 * t.y[1] - t.y[0];
+        }
+        if(i % 13 == 0)
+            t.y[2] = t.y[1] = t.y[0];
+        gfx.fillScreen(0);
+        GFXTest::clearDirtyRects(gfx);
+        gfx.drawFilledTriangle(t.x[0], t.y[0], t.x[1], t.y[1], t.x[2], t.y[2], 1);
+        if(!drawnLikeReference(&t))
+            return 1;
+    }
+    puts("3000 clipped triangles match the top-left rule reference");
+
+    // Fans around a point: every pixel is drawn by one triangle at most
+    static uint8_t count[480][320];
+    for(int i = 0; i < 50; i++) {
+        memset(count, 0, sizeof(count));
+        int16_t cx = rand() % 320;
+        int16_t cy = rand() % 480;
+        int n = 3 + rand() % 20;
+        int16_t px[23], py[23];
+        for(int k = 0; k < n; k++) {
+            float angle = 2 * M_PI * k / n;
+            int16_t radius = 50 + rand() % 300;
+            px[k] = cx + radius * cos(angle);
+            py[k] = cy + radius * sin(angle);
+        }
+        for(int k = 0; k < n; k++) {
+            gfx.fillScreen(0);
+            gfx.drawFilledTriangle(cx, cy, px[k], py[k], px[(k + 1) % n], py[(k + 1) % n], 1);
+            for(int16_t y = 0; y < 480; y++)
+                for(int16_t x = 0; x < 320; x++)
+                    count[y][x] += (GFXTest::getPixel(gfx, x, y) == 1);
+        }
+        for(int16_t y = 0; y < 480; y++) {
+            for(int16_t x = 0; x < 320; x++) {
+                if(count[y][x] > 1) {
+                    printf("FAIL fan %d overlaps at %d,%d\n", i, x, y);
+                    return 1;
+                }
+            }
+        }
+    }
+    puts("50 triangle fans never overlap");
+
+    const int benchmarkSizes[] = {8, 20, 100, 320, 1000, 0};
+    for(int size : benchmarkSizes) {
+        for(int i = 0; i < TRIANGLES; i++)
+            randomTriangle(&triangles[i], size);
+        double referenceTime = 1e9, time = 1e9;
+        for(int run = 0; run < 5; run++) {
+            referenceTime = min(referenceTime, triangles1000(reference));
+            time = min(time, triangles1000(gfx));
+        }
+        if(size)
+            printf("1000 triangles, size %4d:  ", size);
+        else
+            printf("1000 triangles, anywhere:   ");
+        printf("reference %7.1f us, new %7.1f us (%.2fx)\n", referenceTime, time, referenceTime / time);
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+/* bench_trig.cpp */
+
+// Accuracy and speed of the Q15 trigonometry against the reference degree
+// table and libm.
+
+#include <stdio.h>
+#include "GFX.h"
+#include "ReferenceGFX.h"
+
+#define CALLS 20000000
+
+volatile float floatSink;
+volatile int32_t intSink;
+
+double nanoseconds(unsigned long start) {
+    return (micros() - start) * 1000.0 / CALLS;
+}
+
+int main() {
+    // Accuracy over float degrees in [-720, 720], 0.001 degree apart
+    double referenceError = 0, sinError = 0, cosError = 0;
+    for(int i = -720000; i <= 720000; i++) {
+        float deg = i / 1000.0f;
+        double expected = sin(deg * M_PI / 180);
+        referenceError = max(referenceError, fabs(referenceSin(deg) - expected));
+        sinError = max(sinError, fabs(fastSin(deg) - expected));
+        cosError = max(cosError, fabs(fastCos(deg) - cos(deg * M_PI / 180)));
+    }
+    double q15Error = 0;
+    for(int angle = 0; angle < ANGLE_STEPS; angle++)
+        q15Error = max(q15Error, fabs(sinQ15(angle) / 32768.0 - sin(angle * 2 * M_PI / ANGLE_STEPS)));
+    double atan2Error = 0;
+    srand(1);
+    for(int i = 0; i < 2000000; i++) {
+        float x = (rand() % 20001 - 10000) / 10.0f;
+        float y = (rand() % 20001 - 10000) / 10.0f;
+        double error = fabs(fastAtan2(y, x) - atan2(y, x) * 180 / M_PI);
+        if(error > 180)
+            error = 360 - error;
+        atan2Error = max(atan2Error, error);
+    }
+    printf("max error: referenceSin %.5f, fastSin %.5f, fastCos %.5f, sinQ15 %.6f, fastAtan2 %.4f degrees\n",
+            referenceError, sinError, cosError, q15Error, atan2Error);
+
+    // Speed, the argument computation is included in every loop
+    float sum = 0;
+    int32_t total = 0;
+    unsigned long start = micros();
+    for(int i = 0; i < CALLS; i++)
+        sum += referenceSin((i * 7) % 1440 - 720);
+    floatSink = sum;
+    double referenceTime = nanoseconds(start);
+    start = micros();
+    for(int i = 0; i < CALLS; i++)
+        sum += fastSin((float)((i * 7) % 1440 - 720));
+    floatSink = sum;
+    double fastSinTime = nanoseconds(start);
+    start = micros();
+    for(int i = 0; i < CALLS; i++)
+        total += sinQ15(i * 7);
+    intSink = total;
+    double sinQ15Time = nanoseconds(start);
+    start = micros();
+    for(int i = 0; i < CALLS; i++)
+        sum += sinf((float)((i * 7) % 1440 - 720) * 0.0174533f);
+    floatSink = sum;
+    double sinfTime = nanoseconds(start);
+    printf("ns/call: referenceSin %.2f, fastSin %.2f, sinQ15 %.2f, sinf %.2f\n",
+            referenceTime, fastSinTime, sinQ15Time, sinfTime);
+
+    start = micros();
+    for(int i = 0; i < CALLS; i++)
+        sum += atan2((double)(i % 2001 - 1000), (double)((i * 7) % 2001 - 1000)) * 57.2957795;
+    floatSink = sum;
+    double atan2Time = nanoseconds(start);
+    start = micros();
+    for(int i = 0; i < CALLS; i++)
+        sum += fastAtan2((float)(i % 2001 - 1000), (float)((i * 7) % 2001 - 1000));
+    floatSink = sum;
+    double fastAtan2Time = nanoseconds(start);
+    printf("ns/call: atan2 (double) %.2f, fastAtan2 %.2f\n", atan2Time, fastAtan2Time);
+    return 0;
+}
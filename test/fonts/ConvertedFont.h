@@ -0,0 +1,214 @@
+/* ConvertedFont.h */
+
+#ifndef _CONVERTED_FONT_H
+#define _CONVERTED_FONT_H
+
+#include <GFX.h>
+
+// Converted from default.bdf by bdf2font.py
+const uint8_t convertedFontData[910] PROGMEM = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x80, 0x80, // 21 !
+    0xA0, 0xA0, // 22 "
+    0x28, 0x28, 0x28, 0xFE, 0x28, 0x28, 0x28, 0xFE, 0x28, 0x28, 0x28, // 23 #
+    0x08, 0x08, 0x3C, 0x4A, 0x88, 0x90, 0x50, 0x38, 0x14, 0x12, 0x22, 0xA4, 0x78, 0x20, 0x20, // 24 $
+    0x42, 0xA4, 0xA4, 0xA8, 0x48, 0x10, 0x24, 0x2A, 0x4A, 0x4A, 0x84, // 25 %
+    0x30, 0x48, 0x48, 0x48, 0x30, 0x20, 0x50, 0x8A, 0x84, 0x8C, 0x72, // 26 &
+    0x80, 0x80, // 27 '
+    0x10, 0x20, 0x40, 0x40, 0x80, 0x80, 0x80, 0x40, 0x40, 0x20, 0x10, // 28 (
+    0x80, 0x40, 0x20, 0x20, 0x10, 0x10, 0x10, 0x20, 0x20, 0x40, 0x80, // 29 )
+    0x10, 0x10, 0xD6, 0x38, 0xFE, 0x38, 0xD6, 0x10, 0x10, // 2A *
+    0x10, 0x10, 0x10, 0xFE, 0x10, 0x10, 0x10, // 2B +
+    0xC0, 0xC0, 0x40, 0x80, // 2C ,
+    0xFE, // 2D -
+    0xC0, 0xC0, // 2E .
+    0x02, 0x02, 0x04, 0x04, 0x08, 0x08, 0x10, 0x10, 0x20, 0x20, 0x40, 0x40, 0x80, 0x80, // 2F /
+    0x38, 0x44, 0x44, 0x86, 0x8A, 0x92, 0xA2, 0xC2, 0x44, 0x44, 0x38, // 30 0
+    0x10, 0x70, 0x90, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0xFE, // 31 1
+    0x38, 0x44, 0x82, 0x82, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0xFE, // 32 2
+    0x38, 0x44, 0x82, 0x82, 0x04, 0x18, 0x04, 0x82, 0x82, 0x44, 0x38, // 33 3
+    0x0C, 0x14, 0x14, 0x24, 0x24, 0x44, 0x44, 0x84, 0xFE, 0x04, 0x04, // 34 4
+    0xFE, 0x80, 0x80, 0x80, 0xF8, 0x04, 0x02, 0x02, 0x02, 0x04, 0xF8, // 35 5
+    0x3C, 0x40, 0x80, 0x80, 0xB8, 0xC4, 0x82, 0x82, 0x82, 0x44, 0x38, // 36 6
+    0xFE, 0x02, 0x04, 0x04, 0x08, 0x10, 0x10, 0x20, 0x40, 0x40, 0x80, // 37 7
+    0x38, 0x44, 0x82, 0x82, 0x44, 0x38, 0x44, 0x82, 0x82, 0x44, 0x38, // 38 8
+    0x38, 0x44, 0x82, 0x82, 0x82, 0x46, 0x3A, 0x02, 0x02, 0x04, 0x78, // 39 9
+    0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xC0, // 3A :
+    0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xC0, 0x40, 0x80, // 3B ;
+    0x08, 0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10, 0x08, // 3C <
+    0xFE, 0x00, 0x00, 0x00, 0xFE, // 3D =
+    0x80, 0x40, 0x20, 0x10, 0x08, 0x10, 0x20, 0x40, 0x80, // 3E >
+    0x38, 0x44, 0x82, 0x82, 0x02, 0x04, 0x08, 0x10, 0x00, 0x10, 0x10, // 3F ?
+    0x38, 0x44, 0x82, 0x82, 0x9A, 0xA6, 0xA2, 0xA2, 0x9C, 0x40, 0x3C, // 40 @
+    0x38, 0x44, 0x82, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x82, // 41 A
+    0xF8, 0x84, 0x82, 0x82, 0x84, 0xF8, 0x84, 0x82, 0x82, 0x84, 0xF8, // 42 B
+    0x3C, 0x42, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x42, 0x3C, // 43 C
+    0xF8, 0x84, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x84, 0xF8, // 44 D
+    0xFE, 0x80, 0x80, 0x80, 0x80, 0xF8, 0x80, 0x80, 0x80, 0x80, 0xFE, // 45 E
+    0xFE, 0x80, 0x80, 0x80, 0x80, 0xF8, 0x80, 0x80, 0x80, 0x80, 0x80, // 46 F
+    0x3C, 0x42, 0x80, 0x80, 0x80, 0x8E, 0x82, 0x82, 0x82, 0x42, 0x3E, // 47 G
+    0x82, 0x82, 0x82, 0x82, 0x82, 0xFE, 0x82, 0x82, 0x82, 0x82, 0x82, // 48 H
+    0xFE, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0xFE, // 49 I
+    0xFE, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x84, 0x48, 0x30, // 4A J
+    0x82, 0x84, 0x88, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x88, 0x84, 0x82, // 4B K
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xFE, // 4C L
+    0x82, 0xC6, 0xAA, 0xAA, 0x92, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, // 4D M
+    0x82, 0xC2, 0xC2, 0xA2, 0xA2, 0x92, 0x8A, 0x8A, 0x86, 0x86, 0x82, // 4E N
+    0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, // 4F O
+    0xF8, 0x84, 0x82, 0x82, 0x84, 0xF8, 0x80, 0x80, 0x80, 0x80, 0x80, // 50 P
+    0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x54, 0x38, 0x12, 0x0C, // 51 Q
+    0xF8, 0x84, 0x82, 0x82, 0x84, 0xF8, 0x90, 0x88, 0x84, 0x82, 0x82, // 52 R
+    0x38, 0x44, 0x82, 0x80, 0x40, 0x38, 0x04, 0x02, 0x82, 0x44, 0x38, // 53 S
+    0xFE, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, // 54 T
+    0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, // 55 U
+    0x82, 0x82, 0x82, 0x44, 0x44, 0x44, 0x28, 0x28, 0x28, 0x10, 0x10, // 56 V
+    0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x44, 0x54, 0x54, 0x6C, 0x44, // 57 W
+    0x82, 0x82, 0x44, 0x44, 0x28, 0x10, 0x28, 0x44, 0x44, 0x82, 0x82, // 58 X
+    0x82, 0x44, 0x44, 0x28, 0x28, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, // 59 Y
+    0xFE, 0x02, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x80, 0xFE, // 5A Z
+    0xF8, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xF8, // 5B [
+    0x80, 0x80, 0x40, 0x40, 0x20, 0x20, 0x10, 0x10, 0x08, 0x08, 0x04, 0x04, 0x02, 0x02, // 5C
+    0xF8, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0xF8, // 5D ]
+    0x10, 0x28, 0x44, 0x82, // 5E ^
+    0xFE, // 5F _
+    0xC0, 0x20, // 60 `
+    0x78, 0x04, 0x02, 0x7E, 0x82, 0x82, 0x86, 0x7A, // 61 a
+    0x80, 0x80, 0x80, 0xB8, 0xC4, 0x82, 0x82, 0x82, 0x82, 0xC4, 0xB8, // 62 b
+    0x38, 0x44, 0x82, 0x80, 0x80, 0x82, 0x44, 0x38, // 63 c
+    0x02, 0x02, 0x02, 0x3A, 0x46, 0x82, 0x82, 0x82, 0x82, 0x46, 0x3A, // 64 d
+    0x38, 0x44, 0x82, 0xFE, 0x80, 0x80, 0x40, 0x3C, // 65 e
+    0x0E, 0x10, 0x20, 0x20, 0x20, 0xFE, 0x20, 0x20, 0x20, 0x20, 0x20, // 66 f
+    0x3A, 0x44, 0x44, 0x44, 0x38, 0x40, 0x80, 0x7C, 0x02, 0x82, 0x7C, // 67 g
+    0x80, 0x80, 0x80, 0xB8, 0xC4, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, // 68 h
+    0x10, 0x00, 0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0xFE, // 69 i
+    0x04, 0x00, 0x3C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x84, 0x78, // 6A j
+    0x80, 0x80, 0x80, 0x80, 0x86, 0x98, 0xA0, 0xC0, 0xA0, 0x98, 0x86, // 6B k
+    0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0xFE, // 6C l
+    0xAC, 0xD2, 0x92, 0x92, 0x92, 0x92, 0x92, 0x92, // 6D m
+    0xB8, 0xC4, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, // 6E n
+    0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x44, 0x38, // 6F o
+    0xB8, 0xC4, 0x82, 0x82, 0x82, 0x82, 0xC4, 0xB8, 0x80, 0x80, 0x80, // 70 p
+    0x3A, 0x46, 0x82, 0x82, 0x82, 0x82, 0x46, 0x3A, 0x02, 0x02, 0x02, // 71 q
+    0xBC, 0xC2, 0x82, 0x80, 0x80, 0x80, 0x80, 0x80, // 72 r
+    0x7C, 0x82, 0x80, 0x78, 0x04, 0x02, 0x84, 0x78, // 73 s
+    0x20, 0x20, 0x20, 0xFE, 0x20, 0x20, 0x20, 0x20, 0x20, 0x10, 0x0E, // 74 t
+    0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x46, 0x3A, // 75 u
+    0x82, 0x82, 0x82, 0x44, 0x44, 0x28, 0x28, 0x10, // 76 v
+    0x82, 0x82, 0x82, 0x44, 0x54, 0x54, 0x28, 0x28, // 77 w
+    0x82, 0x44, 0x28, 0x10, 0x10, 0x28, 0x44, 0x82, // 78 x
+    0x82, 0x82, 0x42, 0x44, 0x24, 0x24, 0x18, 0x08, 0x10, 0x60, // 79 y
+    0xFE, 0x02, 0x04, 0x18, 0x20, 0x40, 0x80, 0xFE, // 7A z
+    0x18, 0x20, 0x20, 0x20, 0x20, 0xC0, 0x20, 0x20, 0x20, 0x20, 0x18, // 7B {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, // 7C |
+    0xC0, 0x20, 0x20, 0x20, 0x20, 0x18, 0x20, 0x20, 0x20, 0x20, 0xC0, // 7D }
+    0x60, 0x92, 0x0C, // 7E ~
+};
+
+const ProportionalGlyph convertedFontGlyphs[95] PROGMEM = {
+    {     0,   0,   0,    0,    0,   8 }, // 20
+    {     0,   1,  11,    3,    2,   8 }, // 21 !
+    {    11,   3,   2,    2,    2,   8 }, // 22 "
+    {    13,   7,  11,    0,    2,   8 }, // 23 #
+    {    24,   7,  15,    0,    0,   8 }, // 24 $
+    {    39,   7,  11,    0,    2,   8 }, // 25 %
+    {    50,   7,  11,    0,    2,   8 }, // 26 &
+    {    61,   1,   2,    3,    2,   8 }, // 27 '
+    {    63,   4,  11,    1,    2,   8 }, // 28 (
+    {    74,   4,  11,    2,    2,   8 }, // 29 )
+    {    85,   7,   9,    0,    3,   8 }, // 2A *
+    {    94,   7,   7,    0,    4,   8 }, // 2B +
+    {   101,   2,   4,    2,   11,   8 }, // 2C ,
+    {   105,   7,   1,    0,    7,   8 }, // 2D -
+    {   106,   2,   2,    2,   11,   8 }, // 2E .
+    {   108,   7,  14,    0,    0,   8 }, // 2F /
+    {   122,   7,  11,    0,    2,   8 }, // 30 0
+    {   133,   7,  11,    0,    2,   8 }, // 31 1
+    {   144,   7,  11,    0,    2,   8 }, // 32 2
+    {   155,   7,  11,    0,    2,   8 }, // 33 3
+    {   166,   7,  11,    0,    2,   8 }, // 34 4
+    {   177,   7,  11,    0,    2,   8 }, // 35 5
+    {   188,   7,  11,    0,    2,   8 }, // 36 6
+    {   199,   7,  11,    0,    2,   8 }, // 37 7
+    {   210,   7,  11,    0,    2,   8 }, // 38 8
+    {   221,   7,  11,    0,    2,   8 }, // 39 9
+    {   232,   2,   9,    2,    4,   8 }, // 3A :
+    {   241,   2,  11,    2,    4,   8 }, // 3B ;
+    {   252,   5,   9,    1,    3,   8 }, // 3C <
+    {   261,   7,   5,    0,    5,   8 }, // 3D =
+    {   266,   5,   9,    1,    3,   8 }, // 3E >
+    {   275,   7,  11,    0,    2,   8 }, // 3F ?
+    {   286,   7,  11,    0,    2,   8 }, // 40 @
+    {   297,   7,  11,    0,    2,   8 }, // 41 A
+    {   308,   7,  11,    0,    2,   8 }, // 42 B
+    {   319,   7,  11,    0,    2,   8 }, // 43 C
+    {   330,   7,  11,    0,    2,   8 }, // 44 D
+    {   341,   7,  11,    0,    2,   8 }, // 45 E
+    {   352,   7,  11,    0,    2,   8 }, // 46 F
+    {   363,   7,  11,    0,    2,   8 }, // 47 G
+    {   374,   7,  11,    0,    2,   8 }, // 48 H
+    {   385,   7,  11,    0,    2,   8 }, // 49 I
+    {   396,   7,  11,    0,    2,   8 }, // 4A J
+    {   407,   7,  11,    0,    2,   8 }, // 4B K
+    {   418,   7,  11,    0,    2,   8 }, // 4C L
+    {   429,   7,  11,    0,    2,   8 }, // 4D M
+    {   440,   7,  11,    0,    2,   8 }, // 4E N
+    {   451,   7,  11,    0,    2,   8 }, // 4F O
+    {   462,   7,  11,    0,    2,   8 }, // 50 P
+    {   473,   7,  13,    0,    2,   8 }, // 51 Q
+    {   486,   7,  11,    0,    2,   8 }, // 52 R
+    {   497,   7,  11,    0,    2,   8 }, // 53 S
+    {   508,   7,  11,    0,    2,   8 }, // 54 T
+    {   519,   7,  11,    0,    2,   8 }, // 55 U
+    {   530,   7,  11,    0,    2,   8 }, // 56 V
+    {   541,   7,  11,    0,    2,   8 }, // 57 W
+    {   552,   7,  11,    0,    2,   8 }, // 58 X
+    {   563,   7,  11,    0,    2,   8 }, // 59 Y
+    {   574,   7,  11,    0,    2,   8 }, // 5A Z
+    {   585,   5,  11,    1,    2,   8 }, // 5B [
+    {   596,   7,  14,    0,    0,   8 }, // 5C
+    {   610,   5,  11,    1,    2,   8 }, // 5D ]
+    {   621,   7,   4,    0,    2,   8 }, // 5E ^
+    {   625,   7,   1,    0,   12,   8 }, // 5F _
+    {   626,   3,   2,    1,    0,   8 }, // 60 `
+    {   628,   7,   8,    0,    5,   8 }, // 61 a
+    {   636,   7,  11,    0,    2,   8 }, // 62 b
+    {   647,   7,   8,    0,    5,   8 }, // 63 c
+    {   655,   7,  11,    0,    2,   8 }, // 64 d
+    {   666,   7,   8,    0,    5,   8 }, // 65 e
+    {   674,   7,  11,    0,    2,   8 }, // 66 f
+    {   685,   7,  11,    0,    4,   8 }, // 67 g
+    {   696,   7,  11,    0,    2,   8 }, // 68 h
+    {   707,   7,  10,    0,    3,   8 }, // 69 i
+    {   717,   6,  12,    0,    3,   8 }, // 6A j
+    {   729,   7,  11,    0,    2,   8 }, // 6B k
+    {   740,   7,  11,    0,    2,   8 }, // 6C l
+    {   751,   7,   8,    0,    5,   8 }, // 6D m
+    {   759,   7,   8,    0,    5,   8 }, // 6E n
+    {   767,   7,   8,    0,    5,   8 }, // 6F o
+    {   775,   7,  11,    0,    5,   8 }, // 70 p
+    {   786,   7,  11,    0,    5,   8 }, // 71 q
+    {   797,   7,   8,    0,    5,   8 }, // 72 r
+    {   805,   7,   8,    0,    5,   8 }, // 73 s
+    {   813,   7,  11,    0,    2,   8 }, // 74 t
+    {   824,   7,   8,    0,    5,   8 }, // 75 u
+    {   832,   7,   8,    0,    5,   8 }, // 76 v
+    {   840,   7,   8,    0,    5,   8 }, // 77 w
+    {   848,   7,   8,    0,    5,   8 }, // 78 x
+    {   856,   7,  10,    0,    5,   8 }, // 79 y
+    {   866,   7,   8,    0,    5,   8 }, // 7A z
+    {   874,   5,  11,    1,    2,   8 }, // 7B {
+    {   885,   1,  11,    3,    2,   8 }, // 7C |
+    {   896,   5,  11,    1,    2,   8 }, // 7D }
+    {   907,   7,   3,    0,    6,   8 }, // 7E ~
+};
+
+ProportionalFont convertedFont = {
+    .data = (uint8_t*)convertedFontData,
+    .glyphs = (ProportionalGlyph*)convertedFontGlyphs,
+    .first = 32,
+    .last = 126,
+    .height = 16,
+    .kerning = NULL,
+    .kerningCount = 0
+};
+
+#endif
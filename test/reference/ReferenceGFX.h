@@ -0,0 +1,47 @@
+/* ReferenceGFX.h */
+
+#ifndef _REFERENCE_GFX_H
+#define _REFERENCE_GFX_H
+
+#include "GFX.h"    // Font and the screen buffer macros
+
+float referenceSin(int deg);
+float referenceCos(int deg);
+
+class ReferenceGFX {
+    public:
+    void begin();   // Allocates the screen buffer, there is no display
+    void fillScreen(uint8_t color);
+    void drawPixel(uint16_t x, uint16_t y, uint8_t color);
+    void drawHorizontalLine(int16_t x, int16_t y, uint16_t width, uint8_t color);
+    void drawVerticalLine(int16_t x, int16_t y, uint16_t height, uint8_t color);
+    void drawLine(int16_t xStart, int16_t yStart, int16_t xEnd, int16_t yEnd, uint8_t color);
+    void drawRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
+    void drawFilledRectangle(int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
+    void drawTriangle(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2, uint8_t color);
+    void drawFilledTriangle(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2, uint8_t color);
+    void drawCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color);
+    void drawFilledCircle(int16_t x, int16_t y, uint16_t radius, uint8_t color);
+    void drawBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height);
+    void drawTransparentBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t transparentColor);
+    void scaleAndRotateBitmap(uint8_t* destination, uint16_t* destinationWidth, uint16_t* destinationHeight,
+            uint8_t* source, uint16_t sourceWidth, uint16_t sourceHeight, float scaleX, float scaleY, float rotation, uint_fast16_t backgroundColor = 0);
+    void copyScreenBufferRect(uint8_t* buffer, int16_t x, int16_t y, uint16_t width, uint16_t height);
+    void drawMonochromeBitmap(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
+    void drawMonochromeBitmap2x(uint8_t* bitmap, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t color);
+    void setFont(Font* f);
+    void drawChar(int16_t x, int16_t y, char character, uint8_t color);
+    void drawChar2x(int16_t x, int16_t y, char character, uint8_t color);
+    void drawString(int16_t x, int16_t y, const char* string, uint8_t color);
+    void drawString2x(int16_t x, int16_t y, const char* string, uint8_t color);
+
+    uint8_t* screenBuffer[2]; // 0 => Top sector, 1 => Bottom sector
+    uint8_t dirtyRects[480][5];
+    Font* font;
+    uint16_t fontSize;
+
+    private:
+    int16_t cropToViewSize(int16_t* start, uint16_t* length, uint16_t viewSize);
+};
+
+#endif
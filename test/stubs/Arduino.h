@@ -0,0 +1,30 @@
+/* Arduino.h */
+
+// Just enough of the Arduino core to build the GFX library on the host.
+
+#ifndef _ARDUINO_H
+#define _ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+#define PROGMEM
+#define OUTPUT  1
+#define LOW     0
+#define HIGH    1
+#define MSBFIRST 1
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline void digitalWrite(uint8_t pin, uint8_t value) {}
+inline void delay(uint32_t ms) {}
+unsigned long micros();
+
+#endif
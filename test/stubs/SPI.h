@@ -0,0 +1,28 @@
+/* SPI.h */
+
+// SPI bus that discards everything, update() costs nothing on the host.
+
+#ifndef _SPI_H
+#define _SPI_H
+
+#include <stdint.h>
+
+#define SPI_MODE0 0
+
+struct SPISettings {
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+class SPIClass {
+    public:
+    void begin() {}
+    void beginTransaction(SPISettings settings) {}
+    void endTransaction() {}
+    void write(uint8_t data) {}
+    void write32(uint32_t data) {}
+    void writePixels(const void* data, uint32_t size) {}
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,12 @@
+/* stubs.cpp */
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <chrono>
+
+SPIClass SPI;
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
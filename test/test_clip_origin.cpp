@@ -0,0 +1,190 @@
+/* test_clip_origin.cpp */
+
+// Every primitive must respect the clipping rectangle and the origin. A
+// random primitive is drawn once without clipping, then again with the same
+// arguments under a clipping rectangle (alone, or nested in another one with
+// an origin): inside the rectangle the pixels must be the same, outside it
+// nothing may change and no cell may be marked dirty. With an origin only,
+// the whole drawing must move by the origin. Nested rectangles that don't
+// overlap draw nothing, and the stack must be back to the full screen after
+// the pops.
+
+#include <stdio.h>
+#include "GFXTest.h"
+#include "RandomPrimitives.h"
+
+GFX full;
+GFX clipped;
+
+void clear(GFX& g) {
+    g.fillScreen(15);
+    GFXTest::clearDirtyRects(g);
+}
+
+bool fullScreenClip(GFX& g) {
+    ClipRect clip = GFXTest::clipRect(g);
+    return clip.left == 0 && clip.top == 0 && clip.right == 319 && clip.bottom == 479 &&
+            clip.originX == 0 && clip.originY == 0 && GFXTest::clipStackSize(g) == 0;
+}
+
+bool checkClipped(int primitive, int16_t left, int16_t top, int16_t right, int16_t bottom) {
+    // Inside the rectangle the pixels of the unclipped drawing, outside it
+    // the background. Cells are dirty only inside the rectangle, and only if
+    // the unclipped drawing marked them.
+    for(int y = 0; y < 480; y++) {
+        for(int x = 0; x < 320; x++) {
+            bool inside = x >= left && x <= right && y >= top && y <= bottom;
+            uint8_t expected = inside ? GFXTest::getPixel(full, x, y) : 15;
+            if(GFXTest::getPixel(clipped, x, y) != expected) {
+                printf("FAIL primitive %d: pixel %d,%d with clip %d,%d-%d,%d\n", primitive, x, y, left, top, right, bottom);
+                return false;
+            }
+        }
+        for(int cell = 0; cell < 5; cell++) {
+            bool inside = y >= top && y <= bottom && cell * 64 <= right && cell * 64 + 63 >= left;
+            if(GFXTest::dirtyRects(clipped)[y][cell] && (!inside || !GFXTest::dirtyRects(full)[y][cell])) {
+                printf("FAIL primitive %d: cell %d of row %d dirty with clip %d,%d-%d,%d\n", primitive, cell, y, left, top, right, bottom);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool checkMoved(int primitive, int16_t originX, int16_t originY) {
+    for(int y = 0; y < 480; y++) {
+        for(int x = 0; x < 320; x++) {
+            int sx = x - originX;
+            int sy = y - originY;
+            if(sx < 0 || sx >= 320 || sy < 0 || sy >= 480)
+                continue;
+            if(GFXTest::getPixel(clipped, x, y) != GFXTest::getPixel(full, sx, sy)) {
+                printf("FAIL primitive %d: pixel %d,%d with origin %d,%d\n", primitive, x, y, originX, originY);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool checkEmpty(int primitive) {
+    for(int y = 0; y < 480; y++) {
+        for(int x = 0; x < 320; x++) {
+            if(GFXTest::getPixel(clipped, x, y) != 15) {
+                printf("FAIL primitive %d: drew with an empty clip\n", primitive);
+                return false;
+            }
+        }
+        for(int cell = 0; cell < 5; cell++) {
+            if(GFXTest::dirtyRects(clipped)[y][cell]) {
+                printf("FAIL primitive %d: marked dirty with an empty clip\n", primitive);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    full.begin();
+    clipped.begin();
+    srand(1);
+    initPrimitives();
+    full.setFont(&font);
+    clipped.setFont(&font);
+
+    for(int i = 0; i < 3000; i++) {
+        int primitive = i % PRIMITIVES;
+        int seed = rand();
+        uint8_t color = i % 15;
+        clear(full);
+        srand(seed);
+        drawPrimitive(full, primitive, color);
+
+        clear(clipped);
+        int mode = (i / PRIMITIVES) % 3;
+        if(mode == 0) {
+            // A clipping rectangle, partly off screen
+            int16_t x = randomBetween(-50, 330);
+            int16_t y = randomBetween(-50, 490);
+            uint16_t width = randomBetween(1, 250);
+            uint16_t height = randomBetween(1, 300);
+            clipped.pushClipRect(x, y, width, height);
+            srand(seed);
+            drawPrimitive(clipped, primitive, color);
+            clipped.popClipRect();
+            if(!checkClipped(primitive, max(x, (int16_t)0), max(y, (int16_t)0), min(x + width - 1, 319), min(y + height - 1, 479)))
+                return 1;
+        } else if(mode == 1) {
+            // A rectangle relative to the origin of an outer one, drawing
+            // with the origin back at the screen origin
+            int16_t originX = randomBetween(-20, 20);
+            int16_t originY = randomBetween(-20, 20);
+            int16_t x = randomBetween(-50, 330);
+            int16_t y = randomBetween(-50, 490);
+            uint16_t width = randomBetween(1, 250);
+            uint16_t height = randomBetween(1, 300);
+            clipped.pushClipRect(10, 20, 300, 400);
+            clipped.setOrigin(originX, originY);
+            clipped.pushClipRect(x, y, width, height);
+            clipped.setOrigin(0, 0);
+            srand(seed);
+            drawPrimitive(clipped, primitive, color);
+            clipped.popClipRect();
+            clipped.popClipRect();
+            int16_t left = max(x + originX, 10);
+            int16_t top = max(y + originY, 20);
+            int16_t right = min(x + originX + width - 1, 309);
+            int16_t bottom = min(y + originY + height - 1, 419);
+            if(!checkClipped(primitive, left, top, right, bottom))
+                return 1;
+        } else {
+            int16_t originX = randomBetween(-200, 200);
+            int16_t originY = randomBetween(-200, 200);
+            clipped.setOrigin(originX, originY);
+            srand(seed);
+            drawPrimitive(clipped, primitive, color);
+            clipped.setOrigin(0, 0);
+            if(!checkMoved(primitive, originX, originY))
+                return 1;
+        }
+        if(!fullScreenClip(clipped)) {
+            printf("FAIL primitive %d: clip stack not restored\n", primitive);
+            return 1;
+        }
+
+        // Two rectangles that don't overlap leave nothing to draw
+        if(i % 7 == 0) {
+            clear(clipped);
+            clipped.pushClipRect(randomBetween(-100, 400), randomBetween(-100, 500), randomBetween(1, 50), randomBetween(1, 50));
+            clipped.pushClipRect(400, 600, 10, 10);
+            srand(seed);
+            drawPrimitive(clipped, primitive, color);
+            clipped.popClipRect();
+            clipped.popClipRect();
+            if(!checkEmpty(primitive))
+                return 1;
+        }
+    }
+
+    // The stack holds CLIP_STACK_DEPTH rectangles, extra pops are ignored
+    for(int i = 0; i < CLIP_STACK_DEPTH; i++) {
+        if(!clipped.pushClipRect(0, 0, 320, 480)) {
+            puts("FAIL pushClipRect within the stack depth");
+            return 1;
+        }
+    }
+    if(clipped.pushClipRect(0, 0, 10, 10)) {
+        puts("FAIL pushClipRect past the stack depth");
+        return 1;
+    }
+    for(int i = 0; i < CLIP_STACK_DEPTH + 2; i++)
+        clipped.popClipRect();
+    if(!fullScreenClip(clipped)) {
+        puts("FAIL clip stack not restored after extra pops");
+        return 1;
+    }
+
+    puts("clip and origin: 3000 random primitives clipped and moved exactly");
+    return 0;
+}
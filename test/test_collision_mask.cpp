@@ -0,0 +1,113 @@
+/* test_collision_mask.cpp */
+
+// CollisionMask::collides must agree with a test of every pixel of the two
+// bitmaps, in both argument orders. Random bitmaps up to 100 pixels wide
+// (four words per row), including empty and full ones, sparse ones whose
+// only pixels sit on the edges, and positions on both sides of each other,
+// negative ones included. Then begin on a mask that is already built, and
+// end.
+
+#include <stdio.h>
+#include "CollisionMask.h"
+
+#define BITMAPS     40
+#define MAX_WIDTH   100
+#define MAX_HEIGHT  40
+#define TRANSPARENT 15
+
+struct Sprite {
+    uint16_t width;
+    uint16_t height;
+    uint8_t pixels[MAX_WIDTH * MAX_HEIGHT];
+    CollisionMask mask;
+};
+
+Sprite sprites[BITMAPS];
+
+int randomBetween(int low, int high) {
+    return low + rand() % (high - low + 1);
+}
+
+void randomSprite(Sprite* sprite, int kind) {
+    sprite->width = randomBetween(1, MAX_WIDTH);
+    sprite->height = randomBetween(1, MAX_HEIGHT);
+    int count = sprite->width * sprite->height;
+    for(int i = 0; i < count; i++) {
+        if(kind == 0)
+            sprite->pixels[i] = TRANSPARENT;                            // Empty
+        else if(kind == 1)
+            sprite->pixels[i] = i % 15;                                 // Full
+        else if(kind == 2)
+            sprite->pixels[i] = (rand() % 40 == 0) ? 1 : TRANSPARENT;   // Sparse
+        else
+            sprite->pixels[i] = (rand() % 3 == 0) ? TRANSPARENT : 2;
+    }
+    if(kind == 2) {
+        // A pixel on the right edge and one on the bottom edge
+        sprite->pixels[sprite->width * randomBetween(0, sprite->height - 1) + sprite->width - 1] = 3;
+        sprite->pixels[sprite->width * (sprite->height - 1) + randomBetween(0, sprite->width - 1)] = 3;
+    }
+}
+
+bool opaque(Sprite* sprite, int u, int v) {
+    if(u < 0 || u >= sprite->width || v < 0 || v >= sprite->height)
+        return false;
+    return sprite->pixels[sprite->width * v + u] != TRANSPARENT;
+}
+
+bool touch(Sprite* a, int16_t ax, int16_t ay, Sprite* b, int16_t bx, int16_t by) {
+    for(int v = 0; v < a->height; v++)
+        for(int u = 0; u < a->width; u++)
+            if(opaque(a, u, v) && opaque(b, ax + u - bx, ay + v - by))
+                return true;
+    return false;
+}
+
+int main() {
+    srand(1);
+    for(int i = 0; i < BITMAPS; i++) {
+        randomSprite(&sprites[i], (i < 2) ? i : 2 + i % 2);
+        if(!sprites[i].mask.begin(sprites[i].pixels, sprites[i].width, sprites[i].height, TRANSPARENT)) {
+            puts("FAIL begin");
+            return 1;
+        }
+    }
+
+    int hits = 0;
+    for(int i = 0; i < 200000; i++) {
+        Sprite* a = &sprites[rand() % BITMAPS];
+        Sprite* b = &sprites[rand() % BITMAPS];
+        int16_t ax = randomBetween(-200, 200);
+        int16_t ay = randomBetween(-200, 200);
+        int16_t bx = ax + randomBetween(-MAX_WIDTH, MAX_WIDTH);
+        int16_t by = ay + randomBetween(-MAX_HEIGHT, MAX_HEIGHT);
+        bool expected = touch(a, ax, ay, b, bx, by);
+        if(a->mask.collides(ax, ay, &b->mask, bx, by) != expected || b->mask.collides(bx, by, &a->mask, ax, ay) != expected) {
+            printf("FAIL %dx%d at %d,%d and %dx%d at %d,%d\n", a->width, a->height, ax, ay, b->width, b->height, bx, by);
+            return 1;
+        }
+        hits += expected;
+    }
+
+    // begin frees the previous mask, and after end the mask collides with
+    // nothing (LeakSanitizer reports the masks that aren't freed)
+    Sprite* full = &sprites[1];
+    CollisionMask mask;
+    for(int i = 0; i < 100; i++)
+        mask.begin(sprites[i % BITMAPS].pixels, sprites[i % BITMAPS].width, sprites[i % BITMAPS].height, TRANSPARENT);
+    mask.begin(full->pixels, full->width, full->height, TRANSPARENT);
+    if(!mask.collides(0, 0, &full->mask, 0, 0)) {
+        puts("FAIL begin again");
+        return 1;
+    }
+    mask.end();
+    if(mask.collides(0, 0, &full->mask, 0, 0) || full->mask.collides(0, 0, &mask, 0, 0)) {
+        puts("FAIL collides after end");
+        return 1;
+    }
+    for(int i = 0; i < BITMAPS; i++)
+        sprites[i].mask.end();
+
+    printf("collision masks: 200000 random pairs (%d touching) match the pixel test\n", hits);
+    return 0;
+}
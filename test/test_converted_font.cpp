@@ -0,0 +1,81 @@
+/* test_converted_font.cpp */
+
+// fonts/ConvertedFont.h is the output of bdf2font.py for fonts/default.bdf,
+// which is the default font as a BDF font (make check also regenerates it and
+// compares). Drawn as a proportional font, it must give the same pixels as
+// the default font drawn with drawString, and mark them dirty. Its glyphs are
+// cropped to their ink, so most of them are narrower than 8 pixels and start
+// anywhere within a byte of the screen: this also checks the partial bytes
+// of drawMonochromeBitmap, with random clipping rectangles and origins.
+
+#include <stdio.h>
+#include "GFXTest.h"
+#include "DefaultFont.h"
+#include "fonts/ConvertedFont.h"
+
+GFX monospaced;
+GFX proportional;
+
+bool drawnPixelsDirty(GFX& gfx) {
+    for(int y = 0; y < 480; y++)
+        for(int x = 0; x < 320; x++)
+            if(GFXTest::getPixel(gfx, x, y) != 15 && !GFXTest::isDirty(gfx, x, y))
+                return false;
+    return true;
+}
+
+int main() {
+    monospaced.begin();
+    proportional.begin();
+    monospaced.setFont(&defaultFont);
+    proportional.setProportionalFont(&convertedFont);
+
+    char text[96];
+    for(int i = 0; i < 95; i++)
+        text[i] = 32 + i;
+    text[95] = 0;
+
+    srand(1);
+    for(int i = 0; i < 5000; i++) {
+        monospaced.fillScreen(15);
+        proportional.fillScreen(15);
+        GFXTest::clearDirtyRects(proportional);
+
+        // A random piece of the text, partly off screen or clipped
+        int start = rand() % 95;
+        int length = 1 + rand() % (95 - start);
+        char string[96];
+        memcpy(string, text + start, length);
+        string[length] = 0;
+        int16_t x = rand() % 360 - 20 - 4 * length;
+        int16_t y = rand() % 520 - 20;
+        bool clip = (i & 1) != 0;
+        int16_t clipX = rand() % 320;
+        int16_t clipY = rand() % 480;
+        uint16_t clipWidth = 1 + rand() % 100;
+        uint16_t clipHeight = 1 + rand() % 40;
+        int16_t originX = rand() % 19 - 9;
+        int16_t originY = rand() % 19 - 9;
+
+        GFX* screens[2] = { &monospaced, &proportional };
+        for(int s = 0; s < 2; s++) {
+            if(clip)
+                screens[s]->pushClipRect(clipX, clipY, clipWidth, clipHeight);
+            screens[s]->setOrigin(originX, originY);
+        }
+        monospaced.drawString(x, y, string, 3);
+        proportional.drawProportionalString(x, y, string, 3);
+        for(int s = 0; s < 2; s++) {
+            screens[s]->setOrigin(0, 0);
+            if(clip)
+                screens[s]->popClipRect();
+        }
+
+        if(!GFXTest::sameScreen(monospaced, proportional) || !drawnPixelsDirty(proportional)) {
+            printf("FAIL \"%s\" at %d,%d%s\n", string, x, y, clip ? " clipped" : "");
+            return 1;
+        }
+    }
+    puts("converted font: 5000 clipped strings identical to the default font");
+    return 0;
+}
@@ -0,0 +1,126 @@
+/* test_copy_rect.cpp */
+
+// copyRect and scrollRegion move pixels inside the target, with overlapping
+// source and destination. Each random copy or scroll is checked against a
+// snapshot taken before it: a written pixel must hold the snapshot pixel it
+// was copied from (or the fill color of a scroll), every other pixel must be
+// unchanged. On the screen, the dirty cells must be exactly the cells of the
+// written pixels. Copies and scrolls are done on the screen (across its two
+// sectors) and on surfaces with a stride, under random clip rectangles and
+// origins, and include pure horizontal, pure vertical and one-pixel moves.
+
+#include <stdio.h>
+#include "GFXTest.h"
+
+#define FILL_COLOR 77
+
+GFX gfx;
+uint8_t snapshot[480][320];
+uint8_t surfacePixels[480 * 400];
+Surface surface = { 0, 0, 400, surfacePixels };
+
+int randomBetween(int low, int high) {
+    return low + rand() % (high - low + 1);
+}
+
+uint8_t& pixel(int x, int y) {
+    if(gfx.getTarget() != NULL)
+        return surface.pixels[surface.stride * y + x];
+    return GFXTest::lineAddress(gfx, y)[x];
+}
+
+int main() {
+    gfx.begin();
+
+    srand(1);
+    for(int i = 0; i < 4000; i++) {
+        // Every fourth move is on a surface, a view of a wider buffer
+        int width = 320;
+        int height = 480;
+        if(i % 4 == 3) {
+            surface.width = width = randomBetween(1, 320);
+            surface.height = height = randomBetween(1, 480);
+            surface.pixels = surfacePixels + randomBetween(0, 79);
+            gfx.setTarget(&surface);
+        } else {
+            gfx.setTarget(NULL);
+        }
+        for(int y = 0; y < height; y++)
+            for(int x = 0; x < width; x++)
+                snapshot[y][x] = pixel(x, y) = x * 7 + y * 13 + i;
+        GFXTest::clearDirtyRects(gfx);
+
+        bool clip = (i & 1) != 0;
+        if(clip)
+            gfx.pushClipRect(randomBetween(-20, width), randomBetween(-20, height), randomBetween(1, 300), randomBetween(1, 400));
+        gfx.setOrigin(randomBetween(-30, 30), randomBetween(-30, 30));
+        ClipRect c = GFXTest::clipRect(gfx);
+
+        bool scroll = (i & 2) != 0;
+        int16_t sourceX = randomBetween(-50, width);
+        int16_t sourceY = randomBetween(-50, height);
+        uint16_t copyWidth = randomBetween(0, 320);
+        uint16_t copyHeight = randomBetween(0, 480);
+        int16_t dx = randomBetween(-80, 80);
+        int16_t dy = randomBetween(-300, 300);
+        if(i % 16 == 4)
+            dx = 0;
+        if(i % 16 == 8)
+            dy = 0;
+        if(i % 16 == 12) {
+            dx = randomBetween(-1, 1);
+            dy = randomBetween(-1, 1);
+        }
+        if(scroll)
+            gfx.scrollRegion(dx, dy, FILL_COLOR);
+        else
+            gfx.copyRect(sourceX, sourceY, copyWidth, copyHeight, sourceX + dx, sourceY + dy);
+
+        for(int y = 0; y < height; y++) {
+            bool dirty[5] = { false, false, false, false, false };
+            for(int x = 0; x < width; x++) {
+                // Screen position (u, v) the pixel comes from, if written
+                bool inside = x >= c.left && x <= c.right && y >= c.top && y <= c.bottom;
+                int u = x - dx;
+                int v = y - dy;
+                uint8_t expected = snapshot[y][x];
+                bool written = false;
+                if(scroll && inside) {
+                    bool covered = u >= c.left && u <= c.right && v >= c.top && v <= c.bottom;
+                    expected = covered ? snapshot[v][u] : FILL_COLOR;
+                    written = true;
+                } else if(!scroll && inside) {
+                    // The destination rect is relative to the origin, the
+                    // source is clipped to the target only
+                    int destinationX = x - c.originX;
+                    int destinationY = y - c.originY;
+                    bool inDestination = destinationX >= sourceX + dx && destinationX < sourceX + dx + copyWidth &&
+                            destinationY >= sourceY + dy && destinationY < sourceY + dy + copyHeight;
+                    if(inDestination && u >= 0 && u < width && v >= 0 && v < height) {
+                        expected = snapshot[v][u];
+                        written = (dx != 0 || dy != 0);
+                    }
+                }
+                if(pixel(x, y) != expected) {
+                    printf("FAIL %d: %s pixel %d,%d\n", i, scroll ? "scroll" : "copy", x, y);
+                    return 1;
+                }
+                if(written)
+                    dirty[DIRTY_RECT_X(x)] = true;
+            }
+            // Surfaces leave the screen dirty cells alone
+            for(int cell = 0; cell < 5; cell++) {
+                bool expectedDirty = dirty[cell] && gfx.getTarget() == NULL;
+                if((GFXTest::dirtyRects(gfx)[y][cell] != 0) != expectedDirty) {
+                    printf("FAIL %d: %s dirty cell %d of row %d\n", i, scroll ? "scroll" : "copy", cell, y);
+                    return 1;
+                }
+            }
+        }
+        if(clip)
+            gfx.popClipRect();
+    }
+    gfx.setTarget(NULL);
+    puts("copyRect and scrollRegion: 4000 random overlapping moves on the screen and on surfaces OK");
+    return 0;
+}
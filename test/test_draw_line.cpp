@@ -0,0 +1,113 @@
+/* test_draw_line.cpp */
+
+// drawLine clips diagonal lines in Bresenham step space with a 64-bit closed
+// form, instead of testing every pixel. It must draw exactly the pixels of
+// the reference, which walks the whole line, for short and long lines and
+// lines far off screen. The reference keeps the error term in an int16_t and
+// never ends lines longer than 32767 pixels: lines with endpoints at the
+// limits of int16_t are checked against the same walk in 64 bits.
+
+#include <stdio.h>
+#include "ScreenCompare.h"
+
+GFX gfx;
+GFX expected;
+ReferenceGFX reference;
+
+void walkLine(int64_t x0, int64_t y0, int64_t x1, int64_t y1, uint8_t color) {
+    // The Bresenham loop of ReferenceGFX::drawLine without overflows
+    bool steep = llabs(y1 - y0) > llabs(x1 - x0);
+    if(steep) {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if(x0 > x1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    int64_t dx = x1 - x0;
+    int64_t dy = llabs(y1 - y0);
+    int64_t err = dx / 2;
+    int64_t yStep = (y0 < y1) ? 1 : -1;
+    for( ; x0 <= x1; x0++) {
+        int64_t px = steep ? y0 : x0;
+        int64_t py = steep ? x0 : y0;
+        if(px >= 0 && px < 320 && py >= 0 && py < 480)
+            expected.drawPixel(px, py, color);
+        err -= dy;
+        if(err < 0) {
+            y0 += yStep;
+            err += dx;
+        }
+    }
+}
+
+bool drawnLikeWalk(int i, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    // Same pixels, and every dirty cell of the walk is dirty
+    bool same = GFXTest::sameScreen(gfx, expected);
+    for(int y = 0; y < 480 && same; y++)
+        for(int x = 0; x < 5; x++)
+            if(GFXTest::dirtyRects(expected)[y][x] && !GFXTest::dirtyRects(gfx)[y][x])
+                same = false;
+    if(!same)
+        printf("FAIL line %d: (%d,%d)-(%d,%d)\n", i, x0, y0, x1, y1);
+    return same;
+}
+
+bool check(int i, int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    if(sameScreen(gfx, reference))
+        return true;
+    printf("FAIL line %d: (%d,%d)-(%d,%d)\n", i, x0, y0, x1, y1);
+    return false;
+}
+
+int main() {
+    gfx.begin();
+    expected.begin();
+    reference.begin();
+
+    // Lines between coordinates on the screen edges, far off screen and at
+    // the limits of int16_t
+    const int16_t far[] = { -32768, -16000, -1, 0, 319, 479, 16000, 32767 };
+    int count = sizeof(far) / sizeof(far[0]);
+    int i = 0;
+    gfx.fillScreen(15);
+    expected.fillScreen(15);
+    GFXTest::clearDirtyRects(gfx);
+    GFXTest::clearDirtyRects(expected);
+    for(int a = 0; a < count; a++)
+        for(int b = 0; b < count; b++)
+            for(int c = 0; c < count; c++) {
+                int16_t x0 = far[a], y0 = far[b], x1 = far[c], y1 = far[(b + c + 1) % count];
+                gfx.drawLine(x0, y0, x1, y1, i & 7);
+                walkLine(x0, y0, x1, y1, i & 7);
+                if(!drawnLikeWalk(i++, x0, y0, x1, y1))
+                    return 1;
+            }
+
+    gfx.fillScreen(15);
+    reference.fillScreen(15);
+    clearDirtyRects(gfx);
+    clearDirtyRects(reference);
+
+    // Random lines around a point of the screen, of four sizes: the long
+    // ones are mostly off screen
+    srand(1);
+    for(i = 0; i < 20000; i++) {
+        int size = (i % 4 == 0) ? 32000 : (i % 4 == 1) ? 1200 : (i % 4 == 2) ? 500 : 40;
+        int cx = rand() % 320;
+        int cy = rand() % 480;
+        int16_t x0 = max(cx + rand() % size - size / 2, -16000);
+        int16_t y0 = max(cy + rand() % size - size / 2, -16000);
+        int16_t x1 = max(cx + rand() % size - size / 2, -16000);
+        int16_t y1 = max(cy + rand() % size - size / 2, -16000);
+        gfx.drawLine(x0, y0, x1, y1, i & 7);
+        reference.drawLine(x0, y0, x1, y1, i & 7);
+        if((i < 2000 || i % 100 == 0) && !check(i, x0, y0, x1, y1))
+            return 1;
+    }
+    if(!check(i, 0, 0, 0, 0))
+        return 1;
+    puts("drawLine: 512 lines to the int16_t limits identical to the walk, 20000 random lines to the reference");
+    return 0;
+}
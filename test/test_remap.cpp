@@ -0,0 +1,151 @@
+/* test_remap.cpp */
+
+// drawRemappedBitmap and drawTransparentRemappedBitmap must draw like
+// drawBitmap and drawTransparentBitmap of a copy of the bitmap remapped in
+// advance, pixels and dirty cells included. The transparent color is tested
+// on the source index, before remapping: in the copy, transparent pixels get
+// a color the table never gives. Random 16 and 256 color bitmaps, tables,
+// flips, clip rectangles and origins. Then the tables of buildRemapTable
+// with the default palette.
+
+#include <stdio.h>
+#include "GFXTest.h"
+
+#define MAX_SIZE 70
+
+GFX gfx;
+GFX expected;
+uint8_t bitmap[MAX_SIZE * MAX_SIZE];
+uint8_t remapped[MAX_SIZE * MAX_SIZE];
+uint8_t table[256];
+
+int randomBetween(int low, int high) {
+    return low + rand() % (high - low + 1);
+}
+
+bool sameDirtyRects(GFX& a, GFX& b) {
+    return memcmp(GFXTest::dirtyRects(a), GFXTest::dirtyRects(b), 480 * 5) == 0;
+}
+
+int unusedColor() {
+    // A color that isn't in the table, or -1
+    bool used[256] = { false };
+    for(int i = 0; i < 256; i++)
+        used[table[i]] = true;
+    for(int i = 0; i < 256; i++)
+        if(!used[i])
+            return i;
+    return -1;
+}
+
+bool checkTable(const char* name, uint16_t size, uint8_t effect, float amount, const uint8_t* expectedTable) {
+    uint8_t built[16];
+    gfx.buildRemapTable(built, size, effect, amount);
+    for(int i = 0; i < size; i++) {
+        if(built[i] != expectedTable[i]) {
+            printf("FAIL %s: color %d becomes %d instead of %d\n", name, i, built[i], expectedTable[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    gfx.begin();
+    expected.begin();
+
+    srand(1);
+    for(int i = 0; i < 20000; i++) {
+        int width = randomBetween(1, MAX_SIZE);
+        int height = randomBetween(1, MAX_SIZE);
+        bool colors256 = (i & 4) != 0;
+        for(int j = 0; j < width * height; j++)
+            bitmap[j] = colors256 ? rand() & 255 : rand() % 16;
+        for(int j = 0; j < 256; j++)
+            table[j] = colors256 ? rand() & 255 : rand() % 16;
+        bool transparent = (i & 1) != 0;
+        uint8_t transparentColor = colors256 ? rand() & 255 : rand() % 16;
+        int unused = unusedColor();
+        if(transparent && unused < 0)
+            continue;
+        for(int j = 0; j < width * height; j++)
+            remapped[j] = (transparent && bitmap[j] == transparentColor) ? unused : table[bitmap[j]];
+        int16_t x = randomBetween(-80, 330);
+        int16_t y = randomBetween(-80, 490);
+        uint8_t flip = randomBetween(0, 3);
+        bool clip = (i & 2) != 0;
+        int16_t clipX = randomBetween(0, 300);
+        int16_t clipY = randomBetween(0, 460);
+        uint16_t clipWidth = randomBetween(1, 200);
+        uint16_t clipHeight = randomBetween(1, 200);
+        int16_t originX = randomBetween(-9, 9);
+        int16_t originY = randomBetween(-9, 9);
+
+        GFX* screens[2] = { &gfx, &expected };
+        for(int s = 0; s < 2; s++) {
+            screens[s]->fillScreen(i & 15);
+            GFXTest::clearDirtyRects(*screens[s]);
+            if(clip)
+                screens[s]->pushClipRect(clipX, clipY, clipWidth, clipHeight);
+            screens[s]->setOrigin(originX, originY);
+        }
+        if(transparent) {
+            gfx.drawTransparentRemappedBitmap(bitmap, x, y, width, height, transparentColor, table, flip);
+            expected.drawTransparentBitmap(remapped, x, y, width, height, unused, flip);
+        } else {
+            gfx.drawRemappedBitmap(bitmap, x, y, width, height, table, flip);
+            expected.drawBitmap(remapped, x, y, width, height, flip);
+        }
+        for(int s = 0; s < 2; s++) {
+            screens[s]->setOrigin(0, 0);
+            if(clip)
+                screens[s]->popClipRect();
+        }
+
+        if(!GFXTest::sameScreen(gfx, expected) || !sameDirtyRects(gfx, expected)) {
+            printf("FAIL %d: %dx%d%s bitmap at %d,%d, flip %d\n", i, width, height, transparent ? " transparent" : "", x, y, flip);
+            return 1;
+        }
+    }
+
+    // With the default palette: 0 white, 1 yellow, 2 orange, 3 red,
+    // 4 violet, 5 indigo, 6 blue, 7 deep sky blue, 8 lime green, 9 dark
+    // green, 10 saddle brown, 11 tan, 12 light gray, 13 dark gray, 14 dim
+    // gray, 15 black
+    const uint8_t identity[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+    const uint8_t white[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    const uint8_t black[16] = { 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15 };
+    const uint8_t firstFour[4] = { 3, 3, 3, 3 };
+    if(!checkTable("white", 16, REMAP_WHITE, 0, white) ||
+            !checkTable("darken 0", 16, REMAP_DARKEN, 0, identity) ||
+            !checkTable("darken 1", 16, REMAP_DARKEN, 1, black) ||
+            !checkTable("hue 0", 16, REMAP_SHIFT_HUE, 0, identity) ||
+            !checkTable("hue 360", 16, REMAP_SHIFT_HUE, 360, identity) ||
+            !checkTable("darken 1 to the closest of 4 colors", 4, REMAP_DARKEN, 1, firstFour))
+        return 1;
+
+    // Hue rotations keep the grays, and a third of a turn moves red to dark
+    // green and blue to red. Darkening by half turns yellow and orange into
+    // saddle brown.
+    uint8_t built[16];
+    for(int angle = 0; angle < 360; angle += 15) {
+        gfx.buildRemapTable(built, 16, REMAP_SHIFT_HUE, angle);
+        if(built[0] != 0 || built[12] != 12 || built[13] != 13 || built[14] != 14 || built[15] != 15) {
+            printf("FAIL hue %d changes a gray\n", angle);
+            return 1;
+        }
+    }
+    gfx.buildRemapTable(built, 16, REMAP_SHIFT_HUE, 120);
+    if(built[3] != 9 || built[6] != 3) {
+        puts("FAIL hue 120");
+        return 1;
+    }
+    gfx.buildRemapTable(built, 16, REMAP_DARKEN, 0.5);
+    if(built[1] != 10 || built[2] != 10) {
+        puts("FAIL darken 0.5");
+        return 1;
+    }
+
+    puts("remap: 20000 random remapped bitmaps and the remap tables OK");
+    return 0;
+}
@@ -0,0 +1,65 @@
+/* test_rotation_cache.cpp */
+
+// RotationCache: invalid angle steps are rejected, cached frames are the
+// output of scaleAndRotateBitmap at the quantized angle, and the least
+// recently used frames are evicted to stay within the memory budget.
+
+#include <stdio.h>
+#include "GFX.h"
+#include "RotationCache.h"
+
+#define CHECK(condition) \
+    if(!(condition)) { printf("FAIL line %d: %s\n", __LINE__, #condition); return 1; }
+
+GFX gfx;
+RotationCache cache;
+uint8_t bitmap[32 * 32];
+uint8_t expected[4624];
+
+int main() {
+    gfx.begin();
+    srand(1);
+    for(int i = 0; i < 32 * 32; i++)
+        bitmap[i] = rand() % 16;
+
+    CHECK(!cache.begin(&gfx, 100000, 0));
+    CHECK(cache.begin(&gfx, 100000, 10));
+
+    // 14 degrees is served by the 10 degree frame, 16 by the 20 degree one
+    for(int angle = 14; angle <= 16; angle += 2) {
+        RotatedFrame* frame = cache.getFrame(bitmap, 32, 32, 1.5, 1.5, angle, 15);
+        CHECK(frame != NULL);
+        uint16_t width, height;
+        gfx.scaleAndRotateBitmap(expected, &width, &height, bitmap, 32, 32, 1.5, 1.5, (angle + 5) / 10 * 10, 15);
+        CHECK(frame->width == width && frame->height == height);
+        CHECK(memcmp(frame->pixels, expected, width * height) == 0);
+    }
+    CHECK(cache.getMisses() == 2);
+    CHECK(cache.getFrame(bitmap, 32, 32, 1.5, 1.5, 11, 15) != NULL);
+    CHECK(cache.getFrame(bitmap, 32, 32, 1.5, 1.5, -340, 15) != NULL);
+    CHECK(cache.getHits() == 2 && cache.getMisses() == 2);
+
+    // A budget of two frames: the third frame evicts the least recently used
+    CHECK(cache.begin(&gfx, 2 * (sizeof(RotatedFrame) + 48 * 48), 10));
+    cache.getFrame(bitmap, 32, 32, 1.5, 1.5, 0, 15);
+    cache.getFrame(bitmap, 32, 32, 1.5, 1.5, 90, 15);
+    cache.getFrame(bitmap, 32, 32, 1.5, 1.5, 0, 15);
+    cache.getFrame(bitmap, 32, 32, 1.5, 1.5, 180, 15);
+    CHECK(cache.getEvictions() == 1);
+    CHECK(cache.getMemoryUsed() <= 2 * (sizeof(RotatedFrame) + 48 * 48));
+    cache.getFrame(bitmap, 32, 32, 1.5, 1.5, 0, 15);
+    CHECK(cache.getHits() == 2 && cache.getMisses() == 3);
+    cache.clear();
+    CHECK(cache.getMemoryUsed() == 0);
+
+    // begin frees the frames of the previous call, end frees the rest
+    cache.getFrame(bitmap, 32, 32, 1.5, 1.5, 0, 15);
+    CHECK(cache.begin(&gfx, 100000, 10));
+    CHECK(cache.getMemoryUsed() == 0);
+    cache.getFrame(bitmap, 32, 32, 1.5, 1.5, 0, 15);
+    cache.end();
+    CHECK(cache.getMemoryUsed() == 0);
+
+    puts("ok");
+    return 0;
+}
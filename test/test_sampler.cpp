@@ -0,0 +1,70 @@
+/* test_sampler.cpp */
+
+// Golden test of the fixed-point scaleAndRotateBitmap sampler against the
+// float sampler of the reference library: every angle at three scales must
+// give the same destination size and almost the same pixels (the two round
+// the source coordinates differently on a few sample positions).
+
+#include <stdio.h>
+#include "GFX.h"
+#include "ReferenceGFX.h"
+
+#define MAX_DIFFERENT_PIXELS    0.003   // Fraction of the sampled pixels
+#define BUFFER_SIZE             40000
+
+GFX gfx;
+ReferenceGFX reference;
+uint8_t bitmap[32 * 32];
+uint8_t expected[BUFFER_SIZE];
+uint8_t actual[BUFFER_SIZE];
+
+int main() {
+    gfx.begin();
+    reference.begin();
+    srand(1);
+    for(int i = 0; i < 32 * 32; i++)
+        bitmap[i] = rand() % 16;
+
+    bool passed = true;
+    const float scales[] = {1.0, 1.5, 3.0};
+    for(float scale : scales) {
+        long differentPixels = 0;
+        long totalPixels = 0;
+        int identicalAngles = 0;
+        for(int angle = 0; angle < 360; angle++) {
+            uint16_t expectedWidth, expectedHeight, actualWidth, actualHeight;
+            reference.scaleAndRotateBitmap(expected, &expectedWidth, &expectedHeight, bitmap, 32, 32, scale, scale, angle, 15);
+            gfx.scaleAndRotateBitmap(actual, &actualWidth, &actualHeight, bitmap, 32, 32, scale, scale, angle, 15);
+            if(expectedWidth != actualWidth || expectedHeight != actualHeight) {
+                printf("FAIL scale %.1f angle %d: size %dx%d, expected %dx%d\n", scale, angle,
+                        actualWidth, actualHeight, expectedWidth, expectedHeight);
+                return 1;
+            }
+            int size = expectedWidth * expectedHeight;
+            int different = 0;
+            for(int i = 0; i < size; i++)
+                different += (expected[i] != actual[i]);
+            differentPixels += different;
+            totalPixels += size;
+            identicalAngles += (different == 0);
+        }
+
+        const int runs = 3000;
+        uint16_t width, height;
+        unsigned long start = micros();
+        for(int i = 0; i < runs; i++)
+            reference.scaleAndRotateBitmap(expected, &width, &height, bitmap, 32, 32, scale, scale, i % 360, 15);
+        double referenceTime = (double)(micros() - start) / runs;
+        start = micros();
+        for(int i = 0; i < runs; i++)
+            gfx.scaleAndRotateBitmap(actual, &width, &height, bitmap, 32, 32, scale, scale, i % 360, 15);
+        double time = (double)(micros() - start) / runs;
+
+        bool ok = differentPixels <= MAX_DIFFERENT_PIXELS * totalPixels;
+        passed = passed && ok;
+        printf("%s scale %.1f: %d/360 angles identical, %ld/%ld pixels differ; float %.2f us, fixed %.2f us (%.2fx)\n",
+                ok ? "ok  " : "FAIL", scale, identicalAngles, differentPixels, totalPixels,
+                referenceTime, time, referenceTime / time);
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+/* test_save_under.cpp */
+
+// drawTransparentBitmapSaveUnder must draw and mark dirty rectangles exactly
+// like drawTransparentBitmap, save the same pixels as copyScreenBufferRect
+// (only the visible part when clipped), and restoreSaveUnder must give back
+// the background. Random bitmaps, flips, clip rectangles and origins, with
+// bitmaps partly or fully off screen.
+
+#include <stdio.h>
+#include "GFXTest.h"
+
+#define MAX_SIZE 70
+#define UNTOUCHED 0xAA
+
+GFX screen;
+GFX reference;
+GFX background;
+uint8_t bitmap[MAX_SIZE * MAX_SIZE];
+uint8_t copied[MAX_SIZE * MAX_SIZE];
+uint8_t saved[MAX_SIZE * MAX_SIZE];
+
+int randomBetween(int low, int high) {
+    return low + rand() % (high - low + 1);
+}
+
+void setView(GFX& gfx, bool clip, int16_t x, int16_t y, uint16_t width, uint16_t height, int16_t originX, int16_t originY) {
+    if(clip)
+        gfx.pushClipRect(x, y, width, height);
+    gfx.setOrigin(originX, originY);
+}
+
+void resetView(GFX& gfx, bool clip) {
+    gfx.setOrigin(0, 0);
+    if(clip)
+        gfx.popClipRect();
+}
+
+bool sameDirtyRects(GFX& a, GFX& b) {
+    return memcmp(GFXTest::dirtyRects(a), GFXTest::dirtyRects(b), 480 * 5) == 0;
+}
+
+int main() {
+    screen.begin();
+    reference.begin();
+    background.begin();
+    for(int y = 0; y < 480; y++)
+        for(int x = 0; x < 320; x++)
+            GFXTest::lineAddress(background, y)[x] = (x * y + x / 7) & 15;
+
+    srand(1);
+    for(int i = 0; i < 3000; i++) {
+        int width = randomBetween(1, MAX_SIZE);
+        int height = randomBetween(1, MAX_SIZE);
+        for(int j = 0; j < width * height; j++)
+            bitmap[j] = (rand() % 3 == 0) ? 15 : rand() % 16;
+        int16_t x = randomBetween(-80, 330);
+        int16_t y = randomBetween(-80, 490);
+        uint8_t flip = randomBetween(0, 3);
+        bool clip = (i & 1) != 0;
+        int16_t clipX = randomBetween(0, 300);
+        int16_t clipY = randomBetween(0, 460);
+        uint16_t clipWidth = randomBetween(1, 200);
+        uint16_t clipHeight = randomBetween(1, 200);
+        int16_t originX = randomBetween(-9, 9);
+        int16_t originY = randomBetween(-9, 9);
+
+        GFXTest::copyScreen(screen, background);
+        GFXTest::copyScreen(reference, background);
+        GFXTest::clearDirtyRects(screen);
+        GFXTest::clearDirtyRects(reference);
+        memset(copied, UNTOUCHED, sizeof(copied));
+        memset(saved, UNTOUCHED, sizeof(saved));
+
+        setView(reference, clip, clipX, clipY, clipWidth, clipHeight, originX, originY);
+        if(!clip)
+            reference.copyScreenBufferRect(copied, x, y, width, height);
+        reference.drawTransparentBitmap(bitmap, x, y, width, height, 15, flip);
+        resetView(reference, clip);
+
+        setView(screen, clip, clipX, clipY, clipWidth, clipHeight, originX, originY);
+        screen.drawTransparentBitmapSaveUnder(bitmap, x, y, width, height, 15, saved, flip);
+        if(!GFXTest::sameScreen(screen, reference) || !sameDirtyRects(screen, reference)) {
+            printf("FAIL %d: draw differs from drawTransparentBitmap\n", i);
+            return 1;
+        }
+
+        if(!clip && memcmp(copied, saved, width * height) != 0) {
+            printf("FAIL %d: saved pixels differ from copyScreenBufferRect\n", i);
+            return 1;
+        }
+        if(clip) {
+            // Only the visible part is saved, the rest of the buffer is untouched
+            int16_t left = max(clipX, (int16_t)0);
+            int16_t top = max(clipY, (int16_t)0);
+            int16_t right = min(clipX + clipWidth - 1, 319);
+            int16_t bottom = min(clipY + clipHeight - 1, 479);
+            for(int v = 0; v < height; v++) {
+                for(int u = 0; u < width; u++) {
+                    int16_t px = x + originX + u;
+                    int16_t py = y + originY + v;
+                    bool visible = px >= left && px <= right && py >= top && py <= bottom;
+                    uint8_t expected = visible ? GFXTest::getPixel(background, px, py) : UNTOUCHED;
+                    if(saved[width * v + u] != expected) {
+                        printf("FAIL %d: clipped save differs at %d,%d\n", i, u, v);
+                        return 1;
+                    }
+                }
+            }
+        }
+
+        screen.restoreSaveUnder(saved, x, y, width, height);
+        resetView(screen, clip);
+        if(!GFXTest::sameScreen(screen, background)) {
+            printf("FAIL %d: restore doesn't give back the background\n", i);
+            return 1;
+        }
+    }
+    puts("save-under: 3000 random bitmaps draw, save and restore OK");
+    return 0;
+}
@@ -0,0 +1,228 @@
+/* test_surfaces.cpp */
+
+// Every primitive drawn into a surface must give the same pixels as on the
+// screen clipped to the size of the surface. Random primitives are drawn into
+// whole surfaces and into views of a rectangle inside a bigger surface, with
+// random origins: the pixels of the parent surface outside the view, the
+// screen buffer and its dirty cells must be left untouched. blitSurface must
+// draw like drawBitmap and drawTransparentBitmap, dirty cells included, for
+// whole surfaces and views, with clip rectangles and origins. Then the
+// setTarget, createSurface and freeSurface edge cases.
+
+#include <stdio.h>
+#include "GFXTest.h"
+#include "RandomPrimitives.h"
+
+#define UNTOUCHED 0xAA
+
+GFX screen;
+GFX expected;
+GFX background;
+uint8_t packed[320 * 480];
+
+bool sameDirtyRects(GFX& a, GFX& b) {
+    return memcmp(GFXTest::dirtyRects(a), GFXTest::dirtyRects(b), 480 * 5) == 0;
+}
+
+bool noDirtyRects(GFX& gfx) {
+    for(int y = 0; y < 480; y++)
+        for(int x = 0; x < 5; x++)
+            if(GFXTest::dirtyRects(gfx)[y][x])
+                return false;
+    return true;
+}
+
+void randomView(Surface* view, Surface* parent) {
+    // The whole parent, or a random rectangle inside it
+    *view = *parent;
+    if(rand() % 2 == 0)
+        return;
+    uint16_t x = randomBetween(0, parent->width - 1);
+    uint16_t y = randomBetween(0, parent->height - 1);
+    view->width = randomBetween(1, parent->width - x);
+    view->height = randomBetween(1, parent->height - y);
+    view->pixels = parent->pixels + parent->stride * y + x;
+}
+
+bool insideView(Surface* view, Surface* parent, int x, int y) {
+    int offset = view->pixels - parent->pixels;
+    int left = offset % parent->stride;
+    int top = offset / parent->stride;
+    return x >= left && x < left + view->width && y >= top && y < top + view->height;
+}
+
+bool drawsLikeScreen(int i) {
+    Surface parent;
+    if(!screen.createSurface(&parent, randomBetween(1, 320), randomBetween(1, 480))) {
+        puts("FAIL createSurface");
+        return false;
+    }
+    memset(parent.pixels, UNTOUCHED, parent.width * parent.height);
+    Surface view;
+    randomView(&view, &parent);
+    int primitive = i % PRIMITIVES;
+    int seed = rand();
+    uint8_t color = i % 15;
+    int16_t originX = randomBetween(-100, 100);
+    int16_t originY = randomBetween(-100, 100);
+
+    expected.fillScreen(UNTOUCHED);
+    expected.pushClipRect(0, 0, view.width, view.height);
+    expected.setOrigin(originX, originY);
+    srand(seed);
+    drawPrimitive(expected, primitive, color);
+    expected.popClipRect();
+
+    GFXTest::copyScreen(screen, background);
+    GFXTest::clearDirtyRects(screen);
+    screen.setTarget(&view);
+    screen.setOrigin(originX, originY);
+    srand(seed);
+    drawPrimitive(screen, primitive, color);
+    screen.setTarget(NULL);
+
+    bool ok = true;
+    for(int y = 0; y < parent.height && ok; y++) {
+        for(int x = 0; x < parent.width && ok; x++) {
+            uint8_t pixel = parent.pixels[parent.stride * y + x];
+            if(!insideView(&view, &parent, x, y)) {
+                if(pixel != UNTOUCHED) {
+                    printf("FAIL primitive %d: drew outside the view at %d,%d\n", primitive, x, y);
+                    ok = false;
+                }
+                continue;
+            }
+            int offset = view.pixels - parent.pixels;
+            int u = x - offset % parent.stride;
+            int v = y - offset / parent.stride;
+            if(pixel != GFXTest::getPixel(expected, u, v)) {
+                printf("FAIL primitive %d: pixel %d,%d of a %dx%d view differs from the screen\n", primitive, u, v, view.width, view.height);
+                ok = false;
+            }
+        }
+    }
+    if(ok && (!GFXTest::sameScreen(screen, background) || !noDirtyRects(screen))) {
+        printf("FAIL primitive %d: drawing into a surface changed the screen\n", primitive);
+        ok = false;
+    }
+    screen.freeSurface(&parent);
+    return ok;
+}
+
+bool blitsLikeBitmap(int i) {
+    Surface parent;
+    screen.createSurface(&parent, randomBetween(1, 120), randomBetween(1, 120));
+    for(int j = 0; j < parent.width * parent.height; j++)
+        parent.pixels[j] = (rand() % 3 == 0) ? 15 : rand() % 16;
+    Surface view;
+    randomView(&view, &parent);
+    for(int y = 0; y < view.height; y++)
+        memcpy(packed + view.width * y, view.pixels + view.stride * y, view.width);
+    int16_t x = randomBetween(-130, 330);
+    int16_t y = randomBetween(-130, 490);
+    bool transparent = (i & 1) != 0;
+    bool clip = (i & 2) != 0;
+    int16_t clipX = randomBetween(-20, 300);
+    int16_t clipY = randomBetween(-20, 460);
+    uint16_t clipWidth = randomBetween(1, 200);
+    uint16_t clipHeight = randomBetween(1, 200);
+    int16_t originX = randomBetween(-9, 9);
+    int16_t originY = randomBetween(-9, 9);
+
+    GFX* screens[2] = { &screen, &expected };
+    for(int s = 0; s < 2; s++) {
+        GFXTest::copyScreen(*screens[s], background);
+        GFXTest::clearDirtyRects(*screens[s]);
+        if(clip)
+            screens[s]->pushClipRect(clipX, clipY, clipWidth, clipHeight);
+        screens[s]->setOrigin(originX, originY);
+    }
+    if(transparent) {
+        screen.blitSurface(&view, x, y, 15);
+        expected.drawTransparentBitmap(packed, x, y, view.width, view.height, 15);
+    } else {
+        screen.blitSurface(&view, x, y);
+        expected.drawBitmap(packed, x, y, view.width, view.height);
+    }
+    for(int s = 0; s < 2; s++) {
+        screens[s]->setOrigin(0, 0);
+        if(clip)
+            screens[s]->popClipRect();
+    }
+    screen.freeSurface(&parent);
+
+    if(!GFXTest::sameScreen(screen, expected) || !sameDirtyRects(screen, expected)) {
+        printf("FAIL blit %d: %dx%d%s at %d,%d differs from the bitmap\n", i, view.width, view.height, transparent ? " transparent" : "", x, y);
+        return false;
+    }
+    return true;
+}
+
+bool clipsToTarget(GFX& gfx, int16_t width, int16_t height) {
+    ClipRect clip = GFXTest::clipRect(gfx);
+    return clip.left == 0 && clip.top == 0 && clip.right == width - 1 && clip.bottom == height - 1 &&
+            clip.originX == 0 && clip.originY == 0 && GFXTest::clipStackSize(gfx) == 0;
+}
+
+int main() {
+    screen.begin();
+    expected.begin();
+    background.begin();
+    srand(1);
+    initPrimitives();
+    screen.setFont(&font);
+    expected.setFont(&font);
+    for(int y = 0; y < 480; y++)
+        for(int x = 0; x < 320; x++)
+            GFXTest::lineAddress(background, y)[x] = (x * y + x / 7) & 15;
+
+    for(int i = 0; i < 2000; i++)
+        if(!drawsLikeScreen(i))
+            return 1;
+    for(int i = 0; i < 2000; i++)
+        if(!blitsLikeBitmap(i))
+            return 1;
+
+    // Surfaces can't be bigger than the screen
+    Surface surface;
+    if(screen.createSurface(&surface, 321, 10) || surface.pixels != NULL || screen.createSurface(&surface, 10, 481)) {
+        puts("FAIL createSurface bigger than the screen");
+        return 1;
+    }
+    Surface big = { 400, 10, 400, packed };
+    if(screen.setTarget(&big) || screen.getTarget() != NULL) {
+        puts("FAIL setTarget bigger than the screen");
+        return 1;
+    }
+
+    // Setting a target resets the clip stack and the origin to the target
+    screen.createSurface(&surface, 40, 30);
+    screen.pushClipRect(5, 5, 10, 10);
+    screen.setOrigin(3, 4);
+    if(!screen.setTarget(&surface) || screen.getTarget() != &surface || !clipsToTarget(screen, 40, 30)) {
+        puts("FAIL setTarget doesn't reset the clipping rectangle");
+        return 1;
+    }
+
+    // A surface isn't blitted onto itself, and copyScreenBufferRect reads
+    // the target
+    screen.fillScreen(7);
+    screen.drawPixel(1, 2, 9);
+    screen.blitSurface(&surface, 1, 1);
+    uint8_t copy[4];
+    screen.copyScreenBufferRect(copy, 0, 2, 2, 2);
+    if(copy[0] != 7 || copy[1] != 9 || copy[2] != 7 || copy[3] != 7 || surface.pixels[surface.stride + 1] != 7) {
+        puts("FAIL blitSurface onto itself or copyScreenBufferRect of a surface");
+        return 1;
+    }
+
+    // Freeing the target goes back to the screen
+    screen.freeSurface(&surface);
+    if(screen.getTarget() != NULL || surface.pixels != NULL || !clipsToTarget(screen, 320, 480)) {
+        puts("FAIL freeSurface of the target");
+        return 1;
+    }
+
+    puts("surfaces: 2000 random primitives in surfaces and views, 2000 blits OK");
+    return 0;
+}
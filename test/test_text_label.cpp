@@ -0,0 +1,187 @@
+/* test_text_label.cpp */
+
+// A TextLabel drawn over a moving scene must look like the scene with the
+// text drawn on top, and erasing it must give back the scene. The scene works
+// like the one of Part 9: every frame its objects are erased with the
+// background color and drawn again at their new position, and points are
+// moved with movePoints. The scene is drawn on two GFX objects, only one of
+// which has the label; the other one draws the text with drawString to give
+// the expected screen.
+
+#include <stdio.h>
+#include "GFXTest.h"
+#include "DefaultFont.h"
+
+#define LABEL_COLOR 0
+#define BACKGROUND_COLOR 15
+#define OBJECT_COUNT 8
+#define POINT_COUNT 64
+
+struct Object {
+    int16_t x;
+    int16_t y;
+    int16_t dx;
+    int16_t dy;
+    bool sprite;
+    uint8_t color;
+};
+
+GFX screen;
+GFX scene;
+GFX expected;
+TextLabel label;
+uint8_t sprite[16 * 16];
+Object objects[OBJECT_COUNT];
+Point points[POINT_COUNT];
+Point oldPoints[POINT_COUNT];
+
+bool matches(const char* text, int16_t x, int16_t y) {
+    GFXTest::copyScreen(expected, scene);
+    expected.drawString(x, y, text, LABEL_COLOR);
+    return GFXTest::sameScreen(expected, screen);
+}
+
+void both(void (*draw)(GFX& gfx)) {
+    draw(screen);
+    draw(scene);
+}
+
+void eraseObjects(GFX& gfx) {
+    for(int i = 0; i < OBJECT_COUNT; i++)
+        gfx.drawFilledRectangle(objects[i].x, objects[i].y, 20, 16, BACKGROUND_COLOR);
+}
+
+void drawObjects(GFX& gfx) {
+    // The scene never uses the label color, see updateLabelCell
+    for(int i = 0; i < OBJECT_COUNT; i++) {
+        if(objects[i].sprite)
+            gfx.drawTransparentBitmap(sprite, objects[i].x, objects[i].y, 16, 16, BACKGROUND_COLOR);
+        else
+            gfx.drawFilledRectangle(objects[i].x, objects[i].y, 20, 12, objects[i].color);
+    }
+}
+
+void movePoints(GFX& gfx) {
+    gfx.movePoints(oldPoints, points, POINT_COUNT, 1, BACKGROUND_COLOR);
+}
+
+void moveScene() {
+    both(eraseObjects);
+    for(int i = 0; i < OBJECT_COUNT; i++) {
+        objects[i].x += objects[i].dx;
+        objects[i].y += objects[i].dy;
+        if(objects[i].x < -24 || objects[i].x > 120)
+            objects[i].dx = -objects[i].dx;
+        if(objects[i].y < -20 || objects[i].y > 40)
+            objects[i].dy = -objects[i].dy;
+    }
+    both(drawObjects);
+    memcpy(oldPoints, points, sizeof(points));
+    for(int i = 0; i < POINT_COUNT; i++)
+        if(rand() % 3 == 0)
+            points[i].y = (points[i].y + 1) % 48;
+    both(movePoints);
+}
+
+void clearScreens() {
+    screen.fillScreen(BACKGROUND_COLOR);
+    scene.fillScreen(BACKGROUND_COLOR);
+}
+
+int main() {
+    screen.begin();
+    scene.begin();
+    expected.begin();
+    screen.setFont(&defaultFont);
+    expected.setFont(&defaultFont);
+
+    if(screen.initTextLabel(NULL, 2, 2, LABEL_COLOR, BACKGROUND_COLOR)) {
+        puts("FAIL initTextLabel accepted no label");
+        return 1;
+    }
+    // Labels that were never initialized are ignored
+    clearScreens();
+    screen.drawTextLabel(&label, 2, 2, "8", LABEL_COLOR);
+    screen.drawTextLabel(NULL, 2, 2, "8", LABEL_COLOR);
+    screen.eraseTextLabel(&label);
+    screen.eraseTextLabel(NULL);
+    if(!matches("", 2, 2)) {
+        puts("FAIL uninitialized label drew");
+        return 1;
+    }
+    if(!screen.initTextLabel(&label, 2, 2, LABEL_COLOR, BACKGROUND_COLOR)) {
+        puts("FAIL initTextLabel");
+        return 1;
+    }
+
+    // A star under a pixel of "8" moves away while the label hides it. When
+    // the "8" becomes a "1" the pixel must go back to the background, not to
+    // the star color.
+    Point star = { 2, 11 };
+    Point movedStar = { 2, 12 };
+    uint8_t* glyph8 = defaultFont.data + 16 * '8';
+    uint8_t* glyph1 = defaultFont.data + 16 * '1';
+    if(!(glyph8[star.y - 2] & (0x80 >> (star.x - 2))) || (glyph1[star.y - 2] & (0x80 >> (star.x - 2)))) {
+        puts("FAIL the star must be under 8 and not under 1");
+        return 1;
+    }
+    screen.drawPoints(&star, 1, 1);
+    scene.drawPoints(&star, 1, 1);
+    screen.drawTextLabel(&label, 2, 2, "8", LABEL_COLOR);
+    screen.movePoints(&star, &movedStar, 1, 1, BACKGROUND_COLOR);
+    scene.movePoints(&star, &movedStar, 1, 1, BACKGROUND_COLOR);
+    screen.drawTextLabel(&label, 2, 2, "1", LABEL_COLOR);
+    if(!matches("1", 2, 2)) {
+        puts("FAIL star moved away under the label");
+        return 1;
+    }
+    screen.eraseTextLabel(&label);
+
+    // Random scene
+    srand(1);
+    clearScreens();
+    for(int i = 0; i < 16 * 16; i++)
+        sprite[i] = 1 + rand() % 15;
+    for(int i = 0; i < OBJECT_COUNT; i++) {
+        objects[i].x = rand() % 140 - 20;
+        objects[i].y = rand() % 60 - 20;
+        objects[i].dx = rand() % 7 - 3;
+        objects[i].dy = rand() % 5 - 2;
+        objects[i].sprite = (i & 1) != 0;
+        objects[i].color = 1 + rand() % 14;
+    }
+    for(int i = 0; i < POINT_COUNT; i++) {
+        points[i].x = rand() % 120;
+        points[i].y = rand() % 48;
+    }
+    memcpy(oldPoints, points, sizeof(points));
+    screen.drawPoints(points, POINT_COUNT, 1);
+    scene.drawPoints(points, POINT_COUNT, 1);
+
+    char text[TEXT_LABEL_LENGTH + 1];
+    int16_t x = 2;
+    int16_t y = 2;
+    for(int frame = 0; frame < 5000; frame++) {
+        moveScene();
+        if(frame % 100 == 99) {
+            x = rand() % 100 - 20;
+            y = rand() % 40 - 20;
+        }
+        snprintf(text, sizeof(text), "%d", (frame % 7 == 0) ? rand() : frame * 37);
+        screen.drawTextLabel(&label, x, y, text, LABEL_COLOR);
+        if(!matches(text, x, y)) {
+            printf("FAIL frame %d: \"%s\" at %d,%d\n", frame, text, x, y);
+            return 1;
+        }
+    }
+    // The erased glyphs leave the background color, until the scene draws
+    // its objects again
+    screen.eraseTextLabel(&label);
+    moveScene();
+    if(!matches("", x, y)) {
+        puts("FAIL eraseTextLabel");
+        return 1;
+    }
+    puts("ok");
+    return 0;
+}
@@ -0,0 +1,142 @@
+/* test_text_layout.cpp */
+
+// TextLayout must wrap words at spaces, break words longer than a line, align
+// each line in the box and lay out the text again only when something
+// changed. The layout is drawn on one GFX object, and the expected lines are
+// drawn with drawChar on another one.
+
+#include <stdio.h>
+#include "GFXTest.h"
+#include "TextLayout.h"
+#include "DefaultFont.h"
+
+// Box of 10 columns of the 8x16 default font
+#define BOX_X 16
+#define BOX_Y 32
+#define BOX_WIDTH 80
+
+GFX screen;
+GFX expected;
+TextLayout layout;
+int failures = 0;
+
+void clear() {
+    screen.fillScreen(15);
+    expected.fillScreen(15);
+}
+
+void expectLine(const char* line, int16_t x, int16_t row) {
+    int16_t y = BOX_Y + row * 16;
+    for(x += BOX_X; *line != 0; line++, x += 8)
+        if(*line != ' ')
+            expected.drawChar(x, y, *line, 0);
+}
+
+void check(const char* name, uint16_t lineCount, uint16_t width) {
+    if(!GFXTest::sameScreen(screen, expected)) {
+        printf("FAIL %s: wrong glyphs\n", name);
+        failures++;
+    }
+    if(layout.getLineCount() != lineCount || layout.getWidth() != width) {
+        printf("FAIL %s: %d lines %d wide, expected %d lines %d wide\n", name,
+                layout.getLineCount(), layout.getWidth(), lineCount, width);
+        failures++;
+    }
+}
+
+void checkLayoutCount(const char* name, uint32_t count) {
+    if(layout.getLayoutCount() != count) {
+        printf("FAIL %s: layout count %u, expected %u\n", name, (unsigned)layout.getLayoutCount(), (unsigned)count);
+        failures++;
+    }
+}
+
+int main() {
+    screen.begin();
+    expected.begin();
+    screen.setFont(&defaultFont);
+    expected.setFont(&defaultFont);
+
+    // begin on a layout that already has buffers must free them
+    if(!layout.begin(&screen, 16) || !layout.begin(&screen, 64)) {
+        puts("FAIL begin");
+        return 1;
+    }
+    layout.setBox(BOX_X, BOX_Y, BOX_WIDTH, 0);
+
+    // Wrap at the last space that fits, dropping the spaces at the break
+    clear();
+    layout.draw("the quick  brown fox", 0);
+    expectLine("the quick", 0, 0);
+    expectLine("brown fox", 0, 1);
+    check("wrap", 2, 72);
+
+    // A word longer than a line is broken, a newline ends the line
+    clear();
+    layout.draw("abcdefghijklmnop xy\nz", 0);
+    expectLine("abcdefghij", 0, 0);
+    expectLine("klmnop xy", 0, 1);
+    expectLine("z", 0, 2);
+    check("long word", 3, 80);
+
+    // Lines of 8 and 4 characters in the 10 column box
+    clear();
+    layout.setAlignment(TEXT_ALIGN_CENTER);
+    layout.draw("a bb ccc dddd", 0);
+    expectLine("a bb ccc", 8, 0);
+    expectLine("dddd", 24, 1);
+    check("center", 2, 64);
+
+    clear();
+    layout.setAlignment(TEXT_ALIGN_RIGHT);
+    layout.draw("a bb ccc dddd", 0);
+    expectLine("a bb ccc", 16, 0);
+    expectLine("dddd", 48, 1);
+    check("right", 2, 64);
+
+    // The box height limits the number of lines
+    clear();
+    layout.setAlignment(TEXT_ALIGN_LEFT);
+    layout.setBox(BOX_X, BOX_Y, BOX_WIDTH, 40);
+    layout.draw("the quick brown fox jumps", 0);
+    expectLine("the quick", 0, 0);
+    expectLine("brown fox", 0, 1);
+    check("box height", 2, 72);
+
+    // The layout is cached until the text, the box size, the alignment, the
+    // scale or the font change, or it is invalidated
+    uint32_t count = layout.getLayoutCount();
+    layout.draw("the quick brown fox jumps", 0);
+    layout.setAlignment(TEXT_ALIGN_LEFT);
+    layout.setBox(BOX_X + 8, BOX_Y, BOX_WIDTH, 40);
+    layout.draw("the quick brown fox jumps", 0);
+    checkLayoutCount("same text", count);
+    layout.draw("the quick brown fox", 0);
+    checkLayoutCount("new text", ++count);
+    layout.setBox(BOX_X, BOX_Y, BOX_WIDTH, 0);
+    layout.draw("the quick brown fox", 0);
+    checkLayoutCount("new box size", ++count);
+    layout.setAlignment(TEXT_ALIGN_RIGHT);
+    layout.draw("the quick brown fox", 0);
+    checkLayoutCount("new alignment", ++count);
+    layout.setScale(2);
+    layout.draw("the quick brown fox", 0);
+    checkLayoutCount("new scale", ++count);
+    layout.invalidate();
+    layout.draw("the quick brown fox", 0);
+    checkLayoutCount("invalidate", ++count);
+
+    // After end, draw does nothing
+    layout.end();
+    clear();
+    layout.draw("the quick brown fox", 0);
+    if(!GFXTest::sameScreen(screen, expected)) {
+        puts("FAIL end: drew after end");
+        failures++;
+    }
+
+    if(failures > 0)
+        return 1;
+    puts("text layout: wrap, long words, alignment and cache OK");
+    return 0;
+}
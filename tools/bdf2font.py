@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""bdf2font.py
+
+Convert a BDF bitmap font to a ProportionalFont header for the GFX library.
+
+Glyph bitmaps are cropped to their ink bounding box and stored with every row
+padded to a whole byte, so that GFX can draw them with drawMonochromeBitmap.
+TrueType/OpenType fonts can be rasterised to BDF first, for example with
+otf2bdf or FontForge.
+
+An optional kerning file lists one pair per line as "<left> <right> <adjust>",
+where left and right are single characters or decimal character codes and
+adjust is the cursor correction in pixels. Lines starting with # are ignored.
+
+Usage:
+    bdf2font.py font.bdf myFont > MyFont.h
+    bdf2font.py --first 32 --last 126 --kerning pairs.txt font.bdf myFont > MyFont.h
+"""
+
+import argparse
+import sys
+
+
+def parse_bdf(path):
+    ascent = None
+    glyphs = {}
+    with open(path, encoding="latin-1") as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == "FONT_ASCENT":
+            ascent = int(fields[1])
+        elif fields[0] == "FONTBOUNDINGBOX" and ascent is None:
+            ascent = int(fields[2]) + int(fields[4])
+        elif fields[0] == "STARTCHAR":
+            glyph = {"encoding": -1, "advance": 0, "bbx": (0, 0, 0, 0), "rows": []}
+            for line in lines:
+                fields = line.split()
+                if not fields:
+                    continue
+                if fields[0] == "ENCODING":
+                    glyph["encoding"] = int(fields[1])
+                elif fields[0] == "DWIDTH":
+                    glyph["advance"] = int(fields[1])
+                elif fields[0] == "BBX":
+                    glyph["bbx"] = tuple(int(v) for v in fields[1:5])
+                elif fields[0] == "BITMAP":
+                    for line in lines:
+                        if line.strip() == "ENDCHAR":
+                            break
+                        glyph["rows"].append(int(line.strip(), 16) if line.strip() else 0)
+                    break
+            if 0 <= glyph["encoding"] <= 255:
+                glyphs[glyph["encoding"]] = glyph
+    if ascent is None:
+        sys.exit("error: the font has no FONT_ASCENT or FONTBOUNDINGBOX")
+    return ascent, glyphs
+
+
+def glyph_pixels(glyph):
+    # Return the set pixels as (x, y) pairs relative to the cursor position
+    # and to the top of the line (y grows downwards)
+    width, height, xOffset, yOffset = glyph["bbx"]
+    rowBits = ((width + 7) // 8) * 8
+    pixels = []
+    for v, row in enumerate(glyph["rows"][:height]):
+        for u in range(width):
+            if row & (1 << (rowBits - 1 - u)):
+                pixels.append((xOffset + u, v - (yOffset + height)))
+    return pixels
+
+
+def crop_glyph(glyph, ascent):
+    pixels = glyph_pixels(glyph)
+    if not pixels:
+        return {"width": 0, "height": 0, "xOffset": 0, "yOffset": 0, "bytes": []}
+    left = min(x for x, _ in pixels)
+    right = max(x for x, _ in pixels)
+    top = min(y for _, y in pixels)
+    bottom = max(y for _, y in pixels)
+    width = right - left + 1
+    height = bottom - top + 1
+    widthBytes = (width + 7) // 8
+    data = [0] * (widthBytes * height)
+    for x, y in pixels:
+        u = x - left
+        v = y - top
+        data[widthBytes * v + (u >> 3)] |= 0x80 >> (u & 7)
+    return {"width": width, "height": height, "xOffset": left, "yOffset": ascent + top, "bytes": data}
+
+
+def parse_character(text):
+    if len(text) == 1:
+        return ord(text)
+    return int(text, 0)
+
+
+def parse_kerning(path):
+    pairs = {}
+    with open(path, encoding="utf-8") as f:
+        for number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            fields = line.split()
+            if len(fields) != 3:
+                sys.exit("error: %s:%d: expected <left> <right> <adjust>" % (path, number))
+            pairs[(parse_character(fields[0]), parse_character(fields[1]))] = int(fields[2])
+    return pairs
+
+
+def character_comment(code):
+    # A backslash at the end of a // comment would continue it on the next line
+    if 32 < code < 127 and chr(code) != "\\":
+        return "%02X %s" % (code, chr(code))
+    return "%02X" % code
+
+
+def check_range(name, value, low, high):
+    if not low <= value <= high:
+        sys.exit("error: %s %d does not fit the ProportionalGlyph format" % (name, value))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a BDF font to a GFX ProportionalFont header")
+    parser.add_argument("bdf", help="input BDF font")
+    parser.add_argument("name", help="C name of the font, e.g. smallFont")
+    parser.add_argument("--first", type=int, default=32, help="first character to convert (default 32)")
+    parser.add_argument("--last", type=int, default=126, help="last character to convert (default 126)")
+    parser.add_argument("--height", type=int, help="line height (default: ascent + descent of the font)")
+    parser.add_argument("--kerning", help="optional kerning pairs file")
+    args = parser.parse_args()
+
+    ascent, glyphs = parse_bdf(args.bdf)
+    lineHeight = args.height
+    if lineHeight is None:
+        bottom = 0
+        for glyph in glyphs.values():
+            bottom = max([bottom] + [y + 1 for _, y in glyph_pixels(glyph)])
+        lineHeight = ascent + bottom
+    check_range("line height", lineHeight, 0, 255)
+
+    data = []
+    entries = []
+    for code in range(args.first, args.last + 1):
+        glyph = glyphs.get(code)
+        if glyph is None:
+            entries.append((code, {"offset": 0, "width": 0, "height": 0, "xOffset": 0, "yOffset": 0, "advance": 0}, []))
+            continue
+        cropped = crop_glyph(glyph, ascent)
+        entry = dict(cropped, offset=len(data), advance=glyph["advance"])
+        check_range("offset", entry["offset"], 0, 65535)
+        check_range("x offset", entry["xOffset"], -128, 127)
+        check_range("y offset", entry["yOffset"], -128, 127)
+        check_range("advance", entry["advance"], 0, 255)
+        entries.append((code, entry, cropped["bytes"]))
+        data.extend(cropped["bytes"])
+
+    kerning = []
+    if args.kerning:
+        for (left, right), adjust in sorted(parse_kerning(args.kerning).items()):
+            check_range("kerning adjustment", adjust, -128, 127)
+            kerning.append((left, right, adjust))
+
+    guard = "_" + "".join("_" + c if c.isupper() else c.upper() for c in args.name) + "_H"
+    out = []
+    out.append("/* %s%s.h */" % (args.name[0].upper(), args.name[1:]))
+    out.append("")
+    out.append("#ifndef %s" % guard)
+    out.append("#define %s" % guard)
+    out.append("")
+    out.append("#include <GFX.h>")
+    out.append("")
+    out.append("// Converted from %s by bdf2font.py" % args.bdf.split("/")[-1])
+    out.append("const uint8_t %sData[%d] PROGMEM = {" % (args.name, max(len(data), 1)))
+    for code, entry, rows in entries:
+        if rows:
+            out.append("    %s, // %s" % (", ".join("0x%02X" % b for b in rows), character_comment(code)))
+    if not data:
+        out.append("    0x00")
+    out.append("};")
+    out.append("")
+    out.append("const ProportionalGlyph %sGlyphs[%d] PROGMEM = {" % (args.name, len(entries)))
+    for code, entry, rows in entries:
+        out.append("    { %5d, %3d, %3d, %4d, %4d, %3d }, // %s" % (entry["offset"], entry["width"], entry["height"],
+                   entry["xOffset"], entry["yOffset"], entry["advance"], character_comment(code)))
+    out.append("};")
+    out.append("")
+    if kerning:
+        out.append("const KerningPair %sKerning[%d] PROGMEM = {" % (args.name, len(kerning)))
+        for left, right, adjust in kerning:
+            out.append("    { 0x%02X, 0x%02X, %d }," % (left, right, adjust))
+        out.append("};")
+        out.append("")
+    out.append("ProportionalFont %s = {" % args.name)
+    out.append("    .data = (uint8_t*)%sData," % args.name)
+    out.append("    .glyphs = (ProportionalGlyph*)%sGlyphs," % args.name)
+    out.append("    .first = %d," % args.first)
+    out.append("    .last = %d," % args.last)
+    out.append("    .height = %d," % lineHeight)
+    out.append("    .kerning = %s," % ("(KerningPair*)%sKerning" % args.name if kerning else "NULL"))
+    out.append("    .kerningCount = %d" % len(kerning))
+    out.append("};")
+    out.append("")
+    out.append("#endif")
+    print("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()